@@ -1,14 +1,30 @@
 ﻿#include <iostream>
 #include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <thread>
 #include <string>
 #include <vector>
 #include <sstream>
 #include <iomanip>
-#include <optional>
+#include <string_view>
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include <locale.h>
 #include "../interpreter.h"
+#include "../pool.h"
+#include "../profile.h"
+#include "../source.h"
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <cerrno>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
 
 static inline std::string trim(const std::string& s) {
     size_t a = s.find_first_not_of(" \t\r\n");
@@ -20,24 +36,43 @@ static inline std::string trim(const std::string& s) {
 static void print_help() {
     std::cout <<
         R"(Prikazy (zacinaji dvojteckou):
-  :run            Spusti kod v bufferu pres interpreter
+  :run            Spusti nove radky bufferu; promenne z predchozich :run zustavaji
+  :reset          Zahodi promenne, dalsi :run spusti cely buffer od zacatku
+  :profile        Spusti cely buffer s merenim a vypise cas a pocet vykonani po radcich a instrukcich
   :print          Vypise buffer s cisly radku
-  :clear          Vymaze buffer
+  :clear          Vymaze buffer i promenne
   :open <soubor>  Nacte buffer ze souboru
   :save <soubor>  Ulozi buffer do souboru
   :help           Zobrazi napovedu
   :quit           Konec
+  Spusteni s prepinacem --dump-bytecode vypise pred kazdym :run prelozeny bytecode,
+  --no-optimize vypne optimalizacni pruchod, --no-jit preklad horkych smycek do nativniho kodu,
+  --profile=out.json profiluje kazdy :run (vzdy cely buffer) a zapise vysledek jako JSON do out.json.
+  "run <soubor>" spusti soubor bez REPL (soubor se jen namapuje do pameti, nic se nekopiruje),
+  prijima --no-optimize, --no-jit, --dump-bytecode a --cache (prelozeny program ulozi vedle
+  souboru jako .czb a pri dalsim spusteni ho pouzije, dokud se zdrojak nezmeni).
+  "batch <slozky|soubory...> [-j N]" spusti vsechny skripty (.txt) paralelne na N vlaknech
+  a vypise jejich vystupy v abecednim poradi souboru; prijima --no-optimize, --no-jit a --cache.
+  run i batch prijimaji limity kazdeho behu: --max-ops=N (instrukce), --timeout=S (sekundy)
+  a --max-memory=MB (pole a slovniky); prekroceny limit ukonci skript chybou.
+  "compare-opt <soubory...>" spusti kazdy soubor s optimalizaci a JIT i bez nich a porovna vystupy.
+  "check <soubory...>" spusti kazdy soubor a porovna vystup s ocekavanym v souboru .out vedle nej.
+  "compile <soubor> -o <program>" prelozi soubor do C++ a systemovym prekladacem ($CXX, jinak c++,
+  na Windows cl) do spustitelneho programu; --keep-cpp ponecha vygenerovany .cpp, prijima --no-optimize.
+  "compile --test <soubory...>" kazdy soubor spusti v interpretu i prelozeny a porovna vystupy.
   Otevrete zdrojovy kod, napr. :open kod.txt, pote napiste :run pro spusteni. zdrojovy kod musi byt ve stejne slozce jako tento program.
   
 Pozn.: vse ostatni se bere jako zdrojovy kod a pridava se do bufferu.)" << "\n";
 }
 
-// Nacteni souboru do stringu
-static std::optional<std::string> load_file(const std::string& path, std::string& err) {
-    std::ifstream in(path, std::ios::in | std::ios::binary);
-    if (!in) { err = "Nelze otevrit soubor: " + path; return std::nullopt; }
-    std::ostringstream ss; ss << in.rdbuf();
-    return ss.str();
+// Rozdeleni na radky bufferu, stejne jako std::getline
+static void split_lines(std::string_view text, std::vector<std::string>& buffer) {
+    buffer.clear();
+    while (!text.empty()) {
+        size_t nl = text.find('\n');
+        buffer.emplace_back(text.substr(0, nl));
+        text.remove_prefix(nl == std::string_view::npos ? text.size() : nl + 1);
+    }
 }
 
 // Ulozeni stringu do souboru
@@ -48,27 +83,396 @@ static bool save_file(const std::string& path, const std::string& data, std::str
     return true;
 }
 
+// Spusti kazdy soubor s optimalizaci i bez ni; vystupy se musi shodovat.
+static int compare_optimizer(int argc, char** argv, int first) {
+    Interpreter plain, optimized;
+    plain.setOptimize(false);
+    plain.setJit(false);
+    int failures = 0;
+    for (int i = first; i < argc; ++i) {
+        std::string err;
+        SourceFile src;
+        if (!src.open(argv[i], err)) { std::cerr << err << "\n"; failures++; continue; }
+        std::string a = plain.run(src.text());
+        std::string b = optimized.run(src.text());
+        if (a == b) {
+            std::cout << "OK      " << argv[i] << "\n";
+        }
+        else {
+            std::cout << "ROZDIL  " << argv[i] << "\n  bez optimalizace: " << a << "\n  s optimalizaci:   " << b << "\n";
+            failures++;
+        }
+    }
+    return failures ? 1 : 0;
+}
+
+// Vystup kazdeho souboru se musi shodovat s ocekavanym ve stejnojmennem
+// .out (to, co vypise "czpp run"); konce radku \r\n se neporovnavaji.
+static int check_expected(int argc, char** argv, int first) {
+    Interpreter interp;
+    int failures = 0;
+    for (int i = first; i < argc; ++i) {
+        std::string err;
+        SourceFile src, out;
+        if (!src.open(argv[i], err)) { std::cerr << err << "\n"; failures++; continue; }
+        std::string outPath = std::filesystem::path(argv[i]).replace_extension(".out").string();
+        if (!out.open(outPath, err)) { std::cout << "CHYBI   " << outPath << "\n"; failures++; continue; }
+        std::string expected(out.text());
+        expected.erase(std::remove(expected.begin(), expected.end(), '\r'), expected.end());
+        std::string actual = interp.run(src.text()) + "\n";
+        if (actual == expected) {
+            std::cout << "OK      " << argv[i] << "\n";
+        }
+        else {
+            std::cout << "ROZDIL  " << argv[i] << "\n  ocekavano: " << expected << "  vystup:    " << actual;
+            failures++;
+        }
+    }
+    return failures ? 1 : 0;
+}
+
+#ifdef _WIN32
+// Argument prikazove radky podle pravidel CommandLineToArgvW: uvozovky
+// a zpetna lomitka pred nimi se zdvoji.
+static std::string quote_arg(const std::string& a) {
+    if (!a.empty() && a.find_first_of(" \t\"") == std::string::npos) return a;
+    std::string q = "\"";
+    size_t slashes = 0;
+    for (char c : a) {
+        if (c == '\\') { slashes++; continue; }
+        q.append(c == '"' ? slashes * 2 + 1 : slashes, '\\');
+        slashes = 0;
+        q += c;
+    }
+    q.append(slashes * 2, '\\');
+    return q + "\"";
+}
+#endif
+
+// Spusti program s argumenty primo, bez shellu: nazvy souboru skriptu se
+// tak nikdy nevykonaji jako prikaz. S output se zachyti standardni vystup,
+// jinak jde do konzole. true = program skoncil s kodem 0.
+static bool run_process(const std::vector<std::string>& args, std::string* output) {
+#ifdef _WIN32
+    std::string cmd;
+    for (const std::string& a : args) cmd += (cmd.empty() ? "" : " ") + quote_arg(a);
+    SECURITY_ATTRIBUTES sa{ sizeof sa, nullptr, TRUE };
+    HANDLE rd = nullptr, wr = nullptr;
+    if (output) {
+        if (!CreatePipe(&rd, &wr, &sa, 0)) return false;
+        SetHandleInformation(rd, HANDLE_FLAG_INHERIT, 0);
+    }
+    STARTUPINFOA si{};
+    si.cb = sizeof si;
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    si.hStdOutput = output ? wr : GetStdHandle(STD_OUTPUT_HANDLE);
+    si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+    PROCESS_INFORMATION pi{};
+    BOOL started = CreateProcessA(nullptr, cmd.data(), nullptr, nullptr, TRUE, 0, nullptr, nullptr, &si, &pi);
+    if (output) {
+        CloseHandle(wr);
+        char buf[4096];
+        DWORD n;
+        while (started && ReadFile(rd, buf, sizeof buf, &n, nullptr) && n > 0) output->append(buf, n);
+        CloseHandle(rd);
+    }
+    if (!started) return false;
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    DWORD code = 1;
+    GetExitCodeProcess(pi.hProcess, &code);
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+    return code == 0;
+#else
+    std::vector<char*> argv;
+    for (const std::string& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+    int fds[2];
+    if (output && pipe(fds) != 0) return false;
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (output) {
+        posix_spawn_file_actions_adddup2(&actions, fds[1], 1);
+        posix_spawn_file_actions_addclose(&actions, fds[0]);
+        posix_spawn_file_actions_addclose(&actions, fds[1]);
+    }
+    pid_t pid;
+    int rc = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (output) {
+        close(fds[1]);
+        char buf[4096];
+        ssize_t n;
+        while (rc == 0 && ((n = read(fds[0], buf, sizeof buf)) > 0 || (n < 0 && errno == EINTR)))
+            if (n > 0) output->append(buf, (size_t)n);
+        close(fds[0]);
+    }
+    if (rc != 0) return false;
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0)
+        if (errno != EINTR) return false;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+// Prelozi vygenerovane C++ systemovym prekladacem. $CXX muze obsahovat i
+// prepinace, rozdeli se na mezerach. Kontrakce na FMA je vypnuta, jinak by
+// plout vychazel jinak nez ve VM.
+static bool build_native(const std::string& cppPath, const std::string& exe, std::string& err) {
+    const char* cxx = std::getenv("CXX");
+    std::vector<std::string> args;
+    std::istringstream words(cxx ? cxx : "");
+    for (std::string w; words >> w;) args.push_back(w);
+    bool ok;
+#ifdef _WIN32
+    if (args.empty()) {
+        // cl vypisuje jmeno souboru na standardni vystup, ten se zahodi
+        args = { "cl", "/nologo", "/std:c++17", "/O2", "/EHsc", "/fp:precise", cppPath, "/Fe:" + exe };
+        std::string ignored;
+        ok = run_process(args, &ignored);
+    }
+    else
+#endif
+    {
+        if (args.empty()) args.push_back("c++");
+        for (const char* a : { "-std=c++17", "-O2", "-ffp-contract=off", "-o" }) args.push_back(a);
+        args.push_back(exe);
+        args.push_back(cppPath);
+        ok = run_process(args, nullptr);
+    }
+    if (!ok) {
+        err = "Preklad C++ selhal:";
+        for (const std::string& a : args) err += " " + a;
+    }
+    return ok;
+}
+
+// Spusti program a vrati jeho standardni vystup.
+static bool run_capture(const std::string& exe, std::string& output) {
+    return run_process({ exe }, &output);
+}
+
+// compile --test: vystup prelozeneho programu se musi shodovat s interpretem.
+// Programy s chybou prekladu se preskoci, ty nelze prelozit ani jednim.
+static int compile_test(Interpreter& interp, const std::vector<std::string>& files) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path dir = fs::temp_directory_path(ec) / ("czpp-compile-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::create_directories(dir, ec);
+    if (ec) { std::cerr << "Nelze vytvorit docasnou slozku: " << dir.string() << "\n"; return 2; }
+    int failures = 0;
+    for (size_t k = 0; k < files.size(); ++k) {
+        std::string err, cpp;
+        SourceFile src;
+        if (!src.open(files[k], err)) { std::cerr << err << "\n"; failures++; continue; }
+        if (!interp.transpile(src.text(), cpp, err)) {
+            std::cout << "PRESKOCENO " << files[k] << " (" << err << ")\n";
+            continue;
+        }
+        std::string base = (dir / "p").string() + std::to_string(k);
+        std::string cppPath = base + ".cpp", exe = base + ".exe";
+        std::string a = interp.run(src.text()), b;
+        if (!save_file(cppPath, cpp, err) || !build_native(cppPath, exe, err)) { std::cerr << err << "\n"; failures++; continue; }
+        if (!run_capture(exe, b)) b += "\n(program skoncil chybou)";
+        if (a == b) {
+            std::cout << "OK      " << files[k] << "\n";
+        }
+        else {
+            std::cout << "ROZDIL  " << files[k] << "\n  interpret: " << a << "\n  prelozeny: " << b << "\n";
+            failures++;
+        }
+    }
+    fs::remove_all(dir, ec);
+    return failures ? 1 : 0;
+}
+
+// Preklad do nativniho programu pres C++. Navratovy kod 1 pri chybe
+// programu, 2 pri chybe souboru nebo prekladace C++.
+static int compile_file(int argc, char** argv, int first) {
+    Interpreter interp;
+    bool keepCpp = false, test = false;
+    std::string exe;
+    std::vector<std::string> files;
+    for (int i = first; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "-o" && i + 1 < argc) exe = argv[++i];
+        else if (a == "--keep-cpp") keepCpp = true;
+        else if (a == "--test") test = true;
+        else if (a == "--no-optimize") interp.setOptimize(false);
+        else files.push_back(a);
+    }
+    if (test) return compile_test(interp, files);
+    if (files.size() != 1) { std::cerr << "Pouziti: czpp compile soubor.txt -o program\n"; return 2; }
+    if (exe.empty()) {
+        exe = std::filesystem::path(files[0]).replace_extension("").string();
+#ifdef _WIN32
+        exe += ".exe";
+#endif
+    }
+    std::string err, cpp;
+    SourceFile src;
+    if (!src.open(files[0], err)) { std::cerr << err << "\n"; return 2; }
+    if (!interp.transpile(src.text(), cpp, err)) { std::cerr << "Chyba: " << err << "\n"; return 1; }
+    std::string cppPath = exe + ".cpp";
+    if (!save_file(cppPath, cpp, err) || !build_native(cppPath, exe, err)) { std::cerr << err << "\n"; return 2; }
+    if (!keepCpp) {
+        std::error_code ec;
+        std::filesystem::remove(cppPath, ec);
+    }
+    return 0;
+}
+
+// Limity behu z prepinacu --max-ops=N, --timeout=S a --max-memory=MB.
+// Vrati false, pokud a neni prepinac limitu.
+static bool parse_limit(const std::string& a, RunLimits& limits) {
+    if (a.rfind("--max-ops=", 0) == 0) limits.maxOps = std::strtoull(a.c_str() + 10, nullptr, 10);
+    else if (a.rfind("--timeout=", 0) == 0) limits.timeout = std::atof(a.c_str() + 10);
+    else if (a.rfind("--max-memory=", 0) == 0) limits.maxMemory = (size_t)(std::atof(a.c_str() + 13) * 1024 * 1024);
+    else return false;
+    return true;
+}
+
+// Cesta k .czb cache vedle zdrojaku
+static std::string cache_path(const std::string& source) {
+    return std::filesystem::path(source).replace_extension(".czb").string();
+}
+
+// Neinteraktivni beh jednoho souboru: bez bufferu radku, interpret cte
+// primo z mapovani. Navratovy kod 1 pri chybe programu, 2 pri chybe souboru.
+static int run_file(int argc, char** argv, int first) {
+    Interpreter interp;
+    bool dumpBytecode = false, cache = false;
+    RunLimits limits;
+    const char* path = nullptr;
+    for (int i = first; i < argc; ++i) {
+        std::string a = argv[i];
+        if (parse_limit(a, limits)) continue;
+        if (a == "--dump-bytecode") dumpBytecode = true;
+        else if (a == "--cache") cache = true;
+        else if (a == "--no-optimize") interp.setOptimize(false);
+        else if (a == "--no-jit") interp.setJit(false);
+        else if (!path) path = argv[i];
+    }
+    if (!path) { std::cerr << "Pouziti: czpp run soubor.txt\n"; return 2; }
+    interp.setLimits(limits);
+    std::string err;
+    SourceFile src;
+    if (!src.open(path, err)) { std::cerr << err << "\n"; return 2; }
+    if (dumpBytecode) std::cout << interp.dumpBytecode(src.text()) << "\n";
+    StreamSink sink(std::cout);
+    if (cache) interp.runCached(src.text(), cache_path(path), sink);
+    else interp.run(src.text(), sink);
+    std::cout << "\n";
+    return interp.lastStats().failed ? 1 : 0;
+}
+
+// Davkovy beh: kazdy skript ma vlastni Interpreter a vlastni buffer vystupu,
+// vypisuje se az na konci v poradi souboru, takze vysledek nezavisi na -j.
+static int run_batch(int argc, char** argv, int first) {
+    unsigned jobs = std::thread::hardware_concurrency();
+    bool optimize = true, jit = true, cache = false;
+    RunLimits limits;
+    std::vector<std::string> files;
+    for (int i = first; i < argc; ++i) {
+        std::string a = argv[i];
+        if (parse_limit(a, limits)) continue;
+        if (a == "-j" && i + 1 < argc) jobs = (unsigned)std::max(1, std::atoi(argv[++i]));
+        else if (a.rfind("-j", 0) == 0 && a.size() > 2) jobs = (unsigned)std::max(1, std::atoi(a.c_str() + 2));
+        else if (a == "--no-optimize") optimize = false;
+        else if (a == "--no-jit") jit = false;
+        else if (a == "--cache") cache = true;
+        else {
+            std::error_code ec;
+            if (!std::filesystem::is_directory(a, ec)) { files.push_back(a); continue; }
+            for (const auto& entry : std::filesystem::directory_iterator(a, ec))
+                if (entry.is_regular_file() && entry.path().extension() == ".txt") files.push_back(entry.path().string());
+        }
+    }
+    if (files.empty()) { std::cerr << "Pouziti: czpp batch slozka/ [-j N]\n"; return 2; }
+    std::sort(files.begin(), files.end());
+
+    struct Result {
+        std::string output;
+        int status = 0; // 0 v poradku, 1 chyba programu, 2 chyba souboru
+    };
+    std::vector<Result> results(files.size());
+    auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(jobs ? jobs : 1);
+        for (size_t k = 0; k < files.size(); ++k) {
+            pool.submit([&, k] {
+                Result& r = results[k];
+                std::string err;
+                SourceFile src;
+                if (!src.open(files[k], err)) { r.output = err; r.status = 2; return; }
+                Interpreter interp;
+                interp.setOptimize(optimize);
+                interp.setJit(jit);
+                interp.setLimits(limits);
+                try {
+                    StringSink sink(r.output);
+                    if (cache) interp.runCached(src.text(), cache_path(files[k]), sink);
+                    else interp.run(src.text(), sink);
+                    r.status = interp.lastStats().failed ? 1 : 0;
+                }
+                catch (const std::exception& e) {
+                    r.output += std::string("Vyjimka: ") + e.what();
+                    r.status = 1;
+                }
+            });
+        }
+        pool.wait();
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    int failed = 0, status = 0;
+    for (size_t k = 0; k < files.size(); ++k) {
+        std::cout << "== " << files[k] << " ==\n" << results[k].output << "\n";
+        failed += results[k].status != 0;
+        status = std::max(status, results[k].status);
+    }
+    std::cerr << files.size() << " skriptu, " << failed << " s chybou, " << std::fixed << std::setprecision(1)
+              << ms << " ms (" << (jobs ? jobs : 1) << " vlaken)\n";
+    return status;
+}
+
 int main(int argc, char** argv) {
 
+    if (argc >= 2 && std::string(argv[1]) == "compare-opt") return compare_optimizer(argc, argv, 2);
+    if (argc >= 2 && std::string(argv[1]) == "check") return check_expected(argc, argv, 2);
+    if (argc >= 2 && std::string(argv[1]) == "run") return run_file(argc, argv, 2);
+    if (argc >= 2 && std::string(argv[1]) == "batch") return run_batch(argc, argv, 2);
+    if (argc >= 2 && std::string(argv[1]) == "compile") return compile_file(argc, argv, 2);
+
     std::vector<std::string> buffer;
     Interpreter interp; // Vas interpreter
+    bool dumpBytecode = false;
+    std::string profilePath;
+    size_t executed = 0; // radky bufferu, ktere uz probehly (inkrementalni :run)
+    const char* fileArg = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--dump-bytecode") dumpBytecode = true;
+        else if (a == "--no-optimize") interp.setOptimize(false);
+        else if (a == "--no-jit") interp.setJit(false);
+        else if (a.rfind("--profile=", 0) == 0) profilePath = a.substr(10);
+        else if (!fileArg) fileArg = argv[i];
+    }
 
     std::cout << "Mini UI pro Interpreter (C++ REPL)\n";
     std::cout << "Zadej :help pro napovedu.\n\n";
 
     // Pokud je predan soubor jako argument, rovnou ho nacteme
-    if (argc >= 2) {
+    if (fileArg) {
         std::string err;
-        auto data = load_file(argv[1], err);
-        if (!data) {
+        SourceFile src;
+        if (!src.open(fileArg, err)) {
             std::cerr << err << "\n";
         }
         else {
-            std::stringstream ss(*data);
-            std::string line;
-            buffer.clear();
-            while (std::getline(ss, line)) buffer.push_back(line);
-            std::cout << "Nacteno z \"" << argv[1] << "\" (" << buffer.size() << " radku).\n";
+            split_lines(src.text(), buffer);
+            std::cout << "Nacteno z \"" << fileArg << "\" (" << buffer.size() << " radku).\n";
         }
     }
 
@@ -105,21 +509,28 @@ int main(int argc, char** argv) {
             }
             if (cmd == "clear" || cmd == "c") {
                 buffer.clear();
+                interp.reset();
+                executed = 0;
                 std::cout << "Buffer vycisten.\n";
                 continue;
             }
+            if (cmd == "reset") {
+                interp.reset();
+                executed = 0;
+                std::cout << "Promenne zahozeny, :run spusti cely buffer znovu.\n";
+                continue;
+            }
             if (cmd == "open" || cmd == "o") {
                 if (arg.empty()) { std::cout << "Pouziti: :open cesta/k/souboru\n"; continue; }
                 std::string err;
-                auto data = load_file(arg, err);
-                if (!data) {
+                SourceFile src;
+                if (!src.open(arg, err)) {
                     std::cerr << err << "\n";
                 }
                 else {
-                    std::stringstream ss(*data);
-                    std::string l;
-                    buffer.clear();
-                    while (std::getline(ss, l)) buffer.push_back(l);
+                    split_lines(src.text(), buffer);
+                    interp.reset();
+                    executed = 0;
                     std::cout << "Nacteno " << buffer.size() << " radku z \"" << arg << "\".\n";
                 }
                 continue;
@@ -140,17 +551,44 @@ int main(int argc, char** argv) {
                 }
                 continue;
             }
-            if (cmd == "run" || cmd == "r") {
-                // poskladat buffer do jednoho stringu
+            if (cmd == "run" || cmd == "r" || cmd == "profile") {
+                // profil meri vzdy cely buffer, :run jen radky od posledniho behu
+                bool profiled = cmd == "profile" || !profilePath.empty();
+                size_t first = profiled ? 0 : executed;
+                if (first == buffer.size()) { std::cout << "(zadne nove radky, :reset spusti cely buffer znovu)\n"; continue; }
                 std::ostringstream ss;
-                for (size_t i = 0; i < buffer.size(); ++i) {
+                for (size_t i = first; i < buffer.size(); ++i) {
                     ss << buffer[i] << "\n";
                 }
                 std::string code = ss.str();
 
+                if (dumpBytecode) std::cout << interp.dumpBytecode(code, !profiled, (uint32_t)first + 1) << "\n";
                 try {
-                    std::string out = interp.run(code);
-                    if (!out.empty()) std::cout << out;
+                    StreamSink sink(std::cout);
+                    if (profiled) {
+                        ProfileReport report;
+                        interp.runProfiled(code, sink, report);
+                        if (cmd == "profile") std::cout << "\n" << report.toTable(&buffer);
+                        if (!profilePath.empty()) {
+                            std::string err;
+                            if (save_file(profilePath, report.toJson(), err)) std::cout << "\nProfil zapsan do \"" << profilePath << "\".\n";
+                            else std::cerr << err << "\n";
+                        }
+                    }
+                    else {
+                        Interpreter::Incremental res = interp.runIncremental(code, sink, (uint32_t)first + 1);
+                        if (res == Interpreter::Incremental::CompileError) {
+                            // chybne radky se neprovedly, at dalsi :run nenarazi na stejnou chybu
+                            buffer.resize(executed);
+                            std::cout << "\nRadky od " << executed + 1 << " byly z bufferu odebrany.\n";
+                        }
+                        else {
+                            // po chybe za behu uz funkce a promenne radku existuji, radky zustanou
+                            if (res == Interpreter::Incremental::RuntimeError)
+                                std::cout << "\nRadky od " << executed + 1 << " zustavaji, jejich funkce a promenne uz jsou deklarovane.\n";
+                            executed = buffer.size();
+                        }
+                    }
                 }
                 catch (const std::string& e) {
                     std::cerr << "Chyba: " << e << "\n";
@@ -0,0 +1,90 @@
+#include "arena.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+static constexpr size_t FirstPage = 64 * 1024;
+
+Arena::~Arena() {
+    reset();
+    while (pages) {
+        Page* next = pages->next;
+        std::free(pages);
+        pages = next;
+    }
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+    uintptr_t p = ((uintptr_t)cur + align - 1) & ~(uintptr_t)(align - 1);
+    if (!cur || p + size > (uintptr_t)end) return grow(size, align);
+    cur = (char*)(p + size);
+    return (void*)p;
+}
+
+// Novy blok aspon dvakrat vetsi nez posledni, at je bloku malo.
+void* Arena::grow(size_t size, size_t align) {
+    size_t want = sizeof(Page) + size + align;
+    size_t bytes = pages ? pages->size * 2 : FirstPage;
+    while (bytes < want) bytes *= 2;
+    Page* c = static_cast<Page*>(std::malloc(bytes));
+    if (!c) throw std::bad_alloc();
+    c->next = pages;
+    c->size = bytes;
+    pages = c;
+    cur = (char*)(c + 1);
+    end = (char*)c + bytes;
+    return allocate(size, align);
+}
+
+void Arena::addFinalizer(void* obj, void (*destroy)(void*)) {
+    Finalizer* f = new (allocate(sizeof(Finalizer), alignof(Finalizer))) Finalizer{ destroy, obj, finalizers };
+    finalizers = f;
+}
+
+void Arena::reset() {
+    for (Finalizer* f = finalizers; f; f = f->next) f->destroy(f->obj);
+    finalizers = nullptr;
+    std::fill(names.begin(), names.end(), std::string_view());
+    nameCount = 0;
+    if (!pages) return;
+    // nejnovejsi blok je nejvetsi, ostatni se vrati systemu
+    Page* keep = pages;
+    for (Page* c = keep->next; c;) {
+        Page* next = c->next;
+        std::free(c);
+        c = next;
+    }
+    keep->next = nullptr;
+    cur = (char*)(keep + 1);
+    end = (char*)keep + keep->size;
+}
+
+std::string_view Arena::intern(std::string_view s) {
+    if ((nameCount + 1) * 2 > names.size()) rehash();
+    size_t mask = names.size() - 1;
+    for (size_t k = std::hash<std::string_view>()(s) & mask;; k = (k + 1) & mask) {
+        std::string_view& slot = names[k];
+        if (slot.data() == nullptr) {
+            char* copy = static_cast<char*>(allocate(s.size() + 1, 1));
+            std::memcpy(copy, s.data(), s.size());
+            copy[s.size()] = '\0';
+            slot = std::string_view(copy, s.size());
+            nameCount++;
+            return slot;
+        }
+        if (slot == s) return slot;
+    }
+}
+
+void Arena::rehash() {
+    std::vector<std::string_view> old(std::max<size_t>(64, names.size() * 2));
+    old.swap(names);
+    size_t mask = names.size() - 1;
+    for (std::string_view s : old) {
+        if (s.data() == nullptr) continue;
+        size_t k = std::hash<std::string_view>()(s) & mask;
+        while (names[k].data() != nullptr) k = (k + 1) & mask;
+        names[k] = s;
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Pole v Areně: ukazatel a delka, bez vlastni alokace a bez destruktoru.
+template <class T>
+struct ArenaList {
+    T* items = nullptr;
+    uint32_t count = 0;
+
+    T* begin() const { return items; }
+    T* end() const { return items + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T& operator[](size_t k) const { return items[k]; }
+    T& back() const { return items[count - 1]; }
+};
+
+// Bump alokator pro objekty jednoho prekladu: uzly AST, pole prikazu a
+// jmena promennych. Nic se neuvolnuje jednotlive, reset() zahodi vse
+// najednou. Nejvetsi blok si arena necha, takze hostitel, ktery spousti
+// skripty jeden za druhym, uz po prvnim behu malloc skoro nevola.
+class Arena {
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena();
+
+    void* allocate(size_t size, size_t align);
+
+    // objekt v arene; destruktor (pokud neni trivialni) zavola reset()
+    template <class T, class... Args>
+    T* make(Args&&... args) {
+        T* obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            addFinalizer(obj, [](void* p) { static_cast<T*>(p)->~T(); });
+        return obj;
+    }
+
+    // kopie n prvku do areny
+    template <class T>
+    ArenaList<T> list(const T* src, size_t n) {
+        static_assert(std::is_trivially_copyable_v<T>, "ArenaList drzi jen jednoduche typy");
+        ArenaList<T> out;
+        if (!n) return out;
+        out.items = static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+        out.count = (uint32_t)n;
+        for (size_t k = 0; k < n; k++) out.items[k] = src[k];
+        return out;
+    }
+
+    // Jedina kopie retezce v arene; stejna jmena dostanou stejny ukazatel.
+    std::string_view intern(std::string_view s);
+
+    // zavola destruktory, uvolni vsechny bloky krome nejvetsiho
+    void reset();
+
+private:
+    struct Page {
+        Page* next;
+        size_t size; // vcetne hlavicky
+    };
+    struct Finalizer {
+        void (*destroy)(void*);
+        void* obj;
+        Finalizer* next;
+    };
+
+    Page* pages = nullptr;
+    char* cur = nullptr;
+    char* end = nullptr;
+    Finalizer* finalizers = nullptr;
+    std::vector<std::string_view> names; // otevrene adresovani, velikost mocnina dvou
+    size_t nameCount = 0;
+
+    void* grow(size_t size, size_t align);
+    void addFinalizer(void* obj, void (*destroy)(void*));
+    void rehash();
+};
+
+// Uvolni arenu na konci oboru, i kdyz preklad skonci vyjimkou.
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) : arena(arena) {}
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+    ~ArenaScope() { arena.reset(); }
+
+private:
+    Arena& arena;
+};
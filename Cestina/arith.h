@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include "value.h"
+
+// Semantika operaci jazyka na jednom miste. Pouziva ji VM za behu
+// i optimalizator pri skladani konstant, aby vysledky byly stejne.
+
+enum class BinOp : uint8_t { Add, Sub, Mul, Div, Lt, Le, Gt, Ge, Eq, Ne };
+
+inline bool isComparison(BinOp op) { return op >= BinOp::Lt; }
+
+// Cela cisla pretekaji modulo 2^64 misto nedefinovaneho chovani.
+inline long long wrapAdd(long long a, long long b) { return (long long)((unsigned long long)a + (unsigned long long)b); }
+inline long long wrapSub(long long a, long long b) { return (long long)((unsigned long long)a - (unsigned long long)b); }
+inline long long wrapMul(long long a, long long b) { return (long long)((unsigned long long)a * (unsigned long long)b); }
+// celociselne deleni nulou dava 0
+inline long long intDiv(long long a, long long b) { return b == 0 ? 0 : b == -1 ? wrapSub(0, a) : a / b; }
+
+inline bool isNumber(const Value& v) { return v.type == Value::INT || v.type == Value::FLOAT; }
+
+inline bool truthy(const Value& v) {
+    return (v.type == Value::INT && v.i != 0) || (v.type == Value::FLOAT && v.f != 0.0) || (v.type == Value::BOOL && v.b);
+}
+
+// Pretypovani pri deklaraci a prirazeni: cele_cislo <-> plout se prevadi,
+// boolean jen z boolean. Vraci false pri typove chybe.
+inline bool coerce(int32_t dest, Value& val) {
+    if (dest == Value::INT) {
+        if (val.type == Value::FLOAT) val = Value::make_int((long long)val.f);
+        return val.type == Value::INT;
+    }
+    if (dest == Value::FLOAT) {
+        if (val.type == Value::INT) val = Value::make_float((double)val.i);
+        return val.type == Value::FLOAT;
+    }
+    return dest == Value::BOOL && val.type == Value::BOOL;
+}
+
+// Binarni aritmetika: promote to float if needed. Vraci false, pokud
+// operand neni cislo.
+inline bool arith(BinOp op, const Value& v, const Value& r, Value& out) {
+    if (!isNumber(v) || !isNumber(r)) return false;
+    if (v.type == Value::FLOAT || r.type == Value::FLOAT) {
+        double lv = (v.type == Value::FLOAT) ? v.f : (double)v.i;
+        double rv = (r.type == Value::FLOAT) ? r.f : (double)r.i;
+        switch (op) {
+        case BinOp::Add: out = Value::make_float(lv + rv); break;
+        case BinOp::Sub: out = Value::make_float(lv - rv); break;
+        case BinOp::Mul: out = Value::make_float(lv * rv); break;
+        case BinOp::Div: out = Value::make_float(lv / rv); break;
+        default: return false;
+        }
+        return true;
+    }
+    switch (op) {
+    case BinOp::Add: out = Value::make_int(wrapAdd(v.i, r.i)); break;
+    case BinOp::Sub: out = Value::make_int(wrapSub(v.i, r.i)); break;
+    case BinOp::Mul: out = Value::make_int(wrapMul(v.i, r.i)); break;
+    case BinOp::Div: out = Value::make_int(intDiv(v.i, r.i)); break;
+    default: return false;
+    }
+    return true;
+}
+
+template <class T>
+inline bool compareAs(BinOp op, T l, T r) {
+    switch (op) {
+    case BinOp::Lt: return l < r;
+    case BinOp::Le: return l <= r;
+    case BinOp::Gt: return l > r;
+    case BinOp::Ge: return l >= r;
+    case BinOp::Eq: return l == r;
+    default: return l != r;
+    }
+}
+
+// Porovnani, vysledek je boolean. Cisla se porovnavaji po povyseni na
+// plout jako u aritmetiky, == a != umi i boolean a retezce. Vraci false
+// pri nesrovnatelnych typech.
+inline bool compare(BinOp op, const Value& v, const Value& r, Value& out) {
+    if (isNumber(v) && isNumber(r)) {
+        if (v.type == Value::FLOAT || r.type == Value::FLOAT) {
+            double lv = (v.type == Value::FLOAT) ? v.f : (double)v.i;
+            double rv = (r.type == Value::FLOAT) ? r.f : (double)r.i;
+            out = Value::make_bool(compareAs(op, lv, rv));
+        }
+        else out = Value::make_bool(compareAs(op, v.i, r.i));
+        return true;
+    }
+    if (op != BinOp::Eq && op != BinOp::Ne) return false;
+    if (v.type == Value::BOOL && r.type == Value::BOOL) { out = Value::make_bool(compareAs(op, v.b, r.b)); return true; }
+    if (v.type == Value::STRING && r.type == Value::STRING) { out = Value::make_bool(compareAs(op, v.str(), r.str())); return true; }
+    return false;
+}
+
+inline bool evalBinary(BinOp op, const Value& v, const Value& r, Value& out) {
+    return isComparison(op) ? compare(op, v, r, out) : arith(op, v, r, out);
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+#include "arith.h"
+#include "value.h"
+
+// Syntakticky strom. Program se rozparsuje jednou a pak se uz jen
+// vyhodnocuji hotove uzly. Uzly, pole prikazu i jmena jsou v Arene
+// a zaniknou spolu s ni po prekladu.
+
+// Vestavene funkce nad poli, volani soucet(a) apod.; delka umi i slovnik
+// a obsahuje(slovnik, klic) ma dva argumenty. User je volani funkce
+// definovane ve skriptu (funkce).
+enum class Builtin : uint8_t { Soucet, Minimum, Maximum, Delka, Obsahuje, User };
+
+struct FuncDef;
+
+struct Expr {
+    enum Kind : uint8_t { Literal, Var, Binary, Index, Call } kind;
+    BinOp op = BinOp::Add;        // Binary
+    Builtin fn = Builtin::Soucet; // Call
+    uint32_t line = 0, col = 0;
+    int32_t slot = -1;            // Var: slot ve framu, doplni Resolver
+    Value::Type type = Value::NONE; // staticky typ vysledku, doplni TypeChecker
+    Value value;                  // Literal
+    std::string_view name;        // Var, interned v Arene
+    Expr* lhs = nullptr;          // Binary; Index: pole nebo slovnik; Call: argument vestavene funkce
+    Expr* rhs = nullptr;          // Binary; Index: index nebo klic; Call obsahuje: klic
+    ArenaList<Expr*> args;        // Call User: argumenty
+    FuncDef* func = nullptr;      // Call User: volana funkce, doplni Resolver
+
+    explicit Expr(Kind k) : kind(k) {}
+};
+using ExprPtr = Expr*;
+
+struct Stmt;
+using StmtPtr = Stmt*;
+
+struct Block {
+    ArenaList<StmtPtr> stmts;
+};
+
+struct Stmt {
+    enum Kind : uint8_t { Decl, Assign, SetIndex, Print, If, While, Func, Return, Eval } kind;
+    Value::Type declType = Value::NONE; // Decl: INT, FLOAT, BOOL, ARRAY_* nebo DICT_*
+    bool hasElse = false;               // If
+    int32_t step = 0;                   // While: nenulovy krok = pocitana smycka, doplni LoopOptimizer
+    uint32_t line = 0, col = 0;
+    int32_t slot = -1;                  // Decl, Assign, SetIndex: slot ve framu, doplni Resolver
+    std::string_view name;              // Decl, Assign, SetIndex, interned v Arene
+    ExprPtr expr = nullptr;             // Decl (muze chybet), Assign, SetIndex, Print, podminka If/While,
+                                        // Return (muze chybet), Eval (volani funkce)
+    ExprPtr index = nullptr;            // SetIndex: index prvku nebo klic; Decl pole: velikost,
+                                        // Decl slovniku: rezerva polozek (muze chybet)
+    Block body;                         // If (vetev pokud), While
+    Block elseBody;                     // If (vetev jinak)
+    FuncDef* func = nullptr;            // Func: definice, jeji telo neni v body
+
+    explicit Stmt(Kind k) : kind(k) {}
+};
+
+// Promenna ve framu. Kazda deklarace dostane vlastni slot, takze typ slotu
+// se nikdy nemeni.
+struct SlotInfo {
+    std::string name;
+    Value::Type type = Value::NONE;
+};
+
+// Parametr funkce.
+struct Param {
+    std::string_view name;
+    Value::Type type = Value::NONE;
+    uint32_t line = 0, col = 0;
+};
+
+// Funkce definovana ve skriptu (jen na nejvyssi urovni). Telo ma vlastni
+// frame: parametry jsou jeho prvni sloty, za nimi lokalni promenne.
+// Promenne programu z nej videt nejsou, funkce ale vidi vsechny funkce
+// vcetne sebe a tech definovanych az za ni.
+struct FuncDef {
+    std::string_view name;
+    Value::Type ret = Value::NONE; // NONE = funkce nevraci hodnotu
+    int32_t index = -1;            // poradi definice, doplni Resolver
+    uint32_t line = 0, col = 0;
+    ArenaList<Param> params;
+    Block body;
+    std::vector<SlotInfo> slots;   // sloty tela, doplni Resolver (LoopOptimizer muze pridat)
+};
+
+// Pozice uzlu pro chybove hlasky, stejny tvar jako tokPos().
+inline std::string nodePos(uint32_t line, uint32_t col) {
+    return " (radek " + std::to_string(line) + ", sloupec " + std::to_string(col) + ")";
+}
@@ -0,0 +1,266 @@
+// czpp_bench: spusti korpus programu pres Interpreter::run a vypise JSON
+// s dobou prekladu a behu, poctem alokaci a spickou RSS pro kazdy program.
+//
+//   czpp_bench [--runs N] [--no-jit] [--no-optimize] [-o vystup.json] [soubor|slozka ...]
+//
+// Bez cest se pouzije bench/korpus a k nemu dva generovane programy
+// (dlouhy kod bez smycek a hluboce vnorene pokud).
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "interpreter.h"
+#include "output.h"
+
+#if !defined(__linux__) && !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifndef CZPP_BENCH_CORPUS
+#define CZPP_BENCH_CORPUS "bench/korpus"
+#endif
+
+// Pocitani alokaci: retezce, pole, slovniky (tabulka zarovnana pres
+// align_val_t) i kontejnery prekladace jdou pres globalni operator new.
+// Nepocitaji se jen bloky Areny, ta je bere primo z malloc (a po prvnim
+// behu je uz jen recykluje).
+static std::atomic<unsigned long long> allocCount{ 0 };
+static std::atomic<unsigned long long> allocBytes{ 0 };
+
+void* operator new(std::size_t n) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(n, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+void* operator new(std::size_t n, std::align_val_t al) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(n, std::memory_order_relaxed);
+    size_t a = (size_t)al;
+#ifdef _WIN32
+    if (void* p = _aligned_malloc(n ? n : 1, a)) return p;
+#else
+    // aligned_alloc chce velikost v nasobcich zarovnani
+    if (void* p = std::aligned_alloc(a, (n + a - 1) / a * a + (n ? 0 : a))) return p;
+#endif
+    throw std::bad_alloc();
+}
+#ifdef _WIN32
+void operator delete(void* p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { _aligned_free(p); }
+#else
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
+
+namespace {
+
+// Vystup programu se jen pocita, at mereni nezkresluje terminal.
+class CountingSink : public OutputSink {
+public:
+    ~CountingSink() override { flush(); }
+    size_t bytes = 0;
+
+protected:
+    void emit(const char*, size_t n) override { bytes += n; }
+};
+
+struct Script {
+    std::string name;
+    std::string source;
+};
+
+struct Result {
+    std::string name;
+    size_t sourceBytes = 0;
+    double compileMin = 0, compileAvg = 0;
+    double executeMin = 0, executeAvg = 0;
+    unsigned long long allocs = 0, allocBytes = 0; // jeden beh
+    long long peakRssKb = -1;
+    size_t outputBytes = 0;
+    bool error = false;
+};
+
+// Spicka RSS od posledniho resetPeakRss(); -1, kde ji nelze zjistit.
+void resetPeakRss() {
+#if defined(__linux__)
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+long long peakRssKb() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.rfind("VmHWM:", 0) == 0) return std::atoll(line.c_str() + 6);
+    return -1;
+#elif !defined(_WIN32)
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+#if defined(__APPLE__)
+    return ru.ru_maxrss / 1024;
+#else
+    return ru.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+// Dlouhy kod bez smycek: parser a prekladac maji hodne prace, VM malo.
+std::string straightLine(int statements) {
+    std::ostringstream src;
+    src << "cele_cislo a = 1;\nplout b = 0.5;\nboolean c = pravda;\n";
+    for (int k = 0; k < statements; k++) {
+        switch (k % 4) {
+        case 0: src << "cele_cislo v" << k << " = a * " << k % 97 << " + " << k << ";\n"; break;
+        case 1: src << "a = a + v" << k - 1 << " / 3 - " << k % 13 << ";\n"; break;
+        case 2: src << "b = b * 1.0001 + a / 7.5;\n"; break;
+        default: src << "c = (a > " << k << ") == c;\n"; break;
+        }
+    }
+    src << "tiskni a;\ntiskni b;\ntiskni c;\n";
+    return src.str();
+}
+
+// Hluboce vnorene pokud/jinak uvnitr smycky.
+std::string deepIf(int depth, int iterations) {
+    std::ostringstream src;
+    src << "cele_cislo i = 0;\ncele_cislo s = 0;\nzatimco (i < " << iterations << ") {\n";
+    for (int d = 0; d < depth; d++) src << "pokud (i > " << d << ") {\ns = s + 1;\n";
+    src << "s = s + i;\n";
+    for (int d = 0; d < depth; d++) src << "} jinak {\ns = s - " << d << ";\n}\n";
+    src << "i = i + 1;\n}\ntiskni s;\n";
+    return src.str();
+}
+
+bool loadFile(const std::filesystem::path& p, std::vector<Script>& out) {
+    std::ifstream in(p, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    out.push_back({ p.stem().string(), ss.str() });
+    return true;
+}
+
+bool loadPath(const std::filesystem::path& p, std::vector<Script>& out) {
+    std::error_code ec;
+    if (!std::filesystem::is_directory(p, ec)) return loadFile(p, out);
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(p, ec))
+        if (entry.path().extension() == ".txt") files.push_back(entry.path());
+    std::sort(files.begin(), files.end());
+    for (const auto& f : files)
+        if (!loadFile(f, out)) return false;
+    return true;
+}
+
+std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+Result measure(Interpreter& interp, const Script& prog, int runs) {
+    Result r;
+    r.name = prog.name;
+    r.sourceBytes = prog.source.size();
+    r.compileMin = r.executeMin = 1e300;
+    resetPeakRss();
+    for (int k = 0; k < runs; k++) {
+        CountingSink sink;
+        unsigned long long count0 = allocCount.load(), bytes0 = allocBytes.load();
+        interp.run(prog.source, sink);
+        sink.flush();
+        r.allocs = allocCount.load() - count0;
+        r.allocBytes = allocBytes.load() - bytes0;
+        r.outputBytes = sink.bytes;
+        const Interpreter::RunStats& t = interp.lastStats();
+        r.error |= t.failed;
+        r.compileMin = std::min(r.compileMin, t.compile);
+        r.executeMin = std::min(r.executeMin, t.execute);
+        r.compileAvg += t.compile / runs;
+        r.executeAvg += t.execute / runs;
+    }
+    r.peakRssKb = peakRssKb();
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int runs = 5;
+    const char* outPath = nullptr;
+    Interpreter interp;
+    std::vector<Script> programs;
+    bool explicitPaths = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--runs" && i + 1 < argc) runs = std::max(1, std::atoi(argv[++i]));
+        else if (a == "-o" && i + 1 < argc) outPath = argv[++i];
+        else if (a == "--no-jit") interp.setJit(false);
+        else if (a == "--no-optimize") interp.setOptimize(false);
+        else {
+            explicitPaths = true;
+            if (!loadPath(a, programs)) {
+                std::cerr << "Nelze nacist " << a << "\n";
+                return 2;
+            }
+        }
+    }
+    if (!explicitPaths) {
+        if (!loadPath(CZPP_BENCH_CORPUS, programs)) {
+            std::cerr << "Nelze nacist korpus " << CZPP_BENCH_CORPUS << "\n";
+            return 2;
+        }
+        programs.push_back({ "gen_rovny_kod", straightLine(20000) });
+        programs.push_back({ "gen_hluboke_pokud", deepIf(64, 20000) });
+    }
+
+    std::ostringstream json;
+    json << "{\n  \"runs\": " << runs << ",\n  \"programs\": [";
+    bool failed = false;
+    for (size_t k = 0; k < programs.size(); k++) {
+        Result r = measure(interp, programs[k], runs);
+        failed |= r.error;
+        char buf[512];
+        std::snprintf(buf, sizeof buf,
+            "%s\n    {\"name\": %s, \"source_bytes\": %zu, \"parse_ms\": %.3f, \"parse_ms_avg\": %.3f, "
+            "\"exec_ms\": %.3f, \"exec_ms_avg\": %.3f, \"allocs\": %llu, \"alloc_bytes\": %llu, "
+            "\"peak_rss_kb\": %lld, \"output_bytes\": %zu, \"error\": %s}",
+            k ? "," : "", jsonString(r.name).c_str(), r.sourceBytes, r.compileMin * 1e3, r.compileAvg * 1e3,
+            r.executeMin * 1e3, r.executeAvg * 1e3, r.allocs, r.allocBytes, r.peakRssKb, r.outputBytes,
+            r.error ? "true" : "false");
+        json << buf;
+    }
+    json << "\n  ]\n}\n";
+
+    if (outPath) {
+        std::ofstream out(outPath, std::ios::binary);
+        out << json.str();
+        if (!out) {
+            std::cerr << "Nelze zapsat " << outPath << "\n";
+            return 2;
+        }
+    }
+    else std::cout << json.str();
+    return failed ? 1 : 0;
+}
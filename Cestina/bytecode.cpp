@@ -0,0 +1,128 @@
+#include "bytecode.h"
+#include <cstdio>
+
+const char* opName(Op op) {
+    static const char* const names[] = {
+#define CZPP_OP_NAME(name) #name,
+        CZPP_OPCODES(CZPP_OP_NAME)
+#undef CZPP_OP_NAME
+    };
+    return names[(size_t)op];
+}
+
+static const char* typeName(int32_t t) {
+    switch (t) {
+    case Value::INT: return "cele_cislo";
+    case Value::FLOAT: return "plout";
+    case Value::BOOL: return "boolean";
+    case Value::ARRAY_INT: return "pole cele_cislo";
+    case Value::ARRAY_FLOAT: return "pole plout";
+    case Value::DICT_INT: return "slovnik cele_cislo";
+    case Value::DICT_FLOAT: return "slovnik plout";
+    default: return "?";
+    }
+}
+
+void relocate(Instr& in, int32_t delta) {
+    switch (in.op) {
+    case Op::JUMP:
+    case Op::JUMP_IF_FALSE:
+    case Op::JUMP_IF_TRUE:
+        in.a += delta;
+        return;
+    case Op::FOR_LT:
+    case Op::FOR_LE:
+    case Op::FOR_GT:
+    case Op::FOR_GE:
+    case Op::FOR_NE:
+        in.c += delta;
+        return;
+    default:
+        return;
+    }
+}
+
+std::string disassemble(const Chunk& chunk) {
+    std::string out;
+    char buf[64];
+    // jmena slotu programu, v tele funkce jeji vlastni
+    const std::vector<std::string>* names = &chunk.slotNames;
+    size_t nextFn = 0;
+    for (size_t k = 0; k < chunk.code.size(); k++) {
+        if (nextFn < chunk.functions.size() && (int32_t)k == chunk.functions[nextFn].entry) {
+            const FuncInfo& f = chunk.functions[nextFn++];
+            out += "\nfunkce " + f.name + " (" + std::to_string(f.params) + " parametru)\n";
+            names = &f.slotNames;
+        }
+        const std::vector<std::string>& slotNames = *names;
+        const Instr& in = chunk.code[k];
+        std::snprintf(buf, sizeof buf, "%04zu  %4u  %-14s", k, chunk.positions[k].line, opName(in.op));
+        out += buf;
+        switch (in.op) {
+        case Op::PUSH_CONST: {
+            const Value& c = chunk.constants[in.a];
+            const char* quote = c.type == Value::STRING ? "\"" : "";
+            out += std::to_string(in.a) + "  ; " + quote + c.toString() + quote;
+            break;
+        }
+        case Op::LOAD_SLOT:
+            out += std::to_string(in.a) + "  ; " + slotNames[in.a];
+            break;
+        case Op::DECL_SLOT:
+        case Op::STORE_SLOT:
+            out += std::to_string(in.a) + "  ; " + typeName(in.b) + " " + slotNames[in.a];
+            break;
+        case Op::JUMP:
+        case Op::JUMP_IF_FALSE:
+        case Op::JUMP_IF_TRUE:
+            out += "-> " + std::to_string(in.a);
+            break;
+        case Op::FOR_LT:
+        case Op::FOR_LE:
+        case Op::FOR_GT:
+        case Op::FOR_GE:
+        case Op::FOR_NE: {
+            int32_t b = in.b;
+            std::string limit = (size_t)b < slotNames.size() ? slotNames[b]
+                : chunk.constants[b - slotNames.size()].toString();
+            out += std::to_string(in.a) + " " + std::to_string(in.b) + " -> " + std::to_string(in.c)
+                + "  ; " + slotNames[in.a] + ", mez " + limit;
+            break;
+        }
+        case Op::EXTRA_ARG:
+            out += std::to_string(in.a);
+            break;
+        case Op::ARR_NEW:
+        case Op::DICT_NEW:
+            out += std::to_string(in.a) + "  ; " + typeName(in.a);
+            break;
+        case Op::ARR_INT:
+        case Op::ARR_FLOAT: {
+            static const char* const ops = "+-*/";
+            static const char* const shapes[] = { "pole, pole", "pole, cislo", "cislo, pole" };
+            out += std::to_string(in.a) + " " + std::to_string(in.b) + "  ; " + ops[in.a & 3] + " (" + shapes[in.b % 3] + ")";
+            break;
+        }
+        case Op::SET_ELEM_INT:
+        case Op::SET_ELEM_FLOAT:
+        case Op::DICT_SET_INT:
+        case Op::DICT_SET_FLOAT:
+            out += std::to_string(in.a) + "  ; " + slotNames[in.a];
+            break;
+        case Op::CALL:
+        case Op::TAILCALL:
+            out += std::to_string(in.a) + " " + std::to_string(in.b) + "  ; " + chunk.functions[in.a].name;
+            break;
+        case Op::REDUCE_INT:
+        case Op::REDUCE_FLOAT: {
+            static const char* const names[] = { "soucet", "minimum", "maximum" };
+            out += std::to_string(in.a) + "  ; " + names[in.a % 3];
+            break;
+        }
+        default:
+            break;
+        }
+        out += '\n';
+    }
+    return out;
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "value.h"
+
+// Seznam instrukci. Z nej se generuje enum, jmena pro vypis a tabulka
+// skoku pro vlaknovy dispatch ve VM, takze poradi staci udrzovat tady.
+#define CZPP_OPCODES(X) \
+    X(PUSH_CONST)    /* push constants[a] */                               \
+    X(LOAD_SLOT)     /* push slots[a] */                                   \
+    X(DECL_SLOT)     /* slots[a] = pop(), b je typ promenne (jen pro vypis) */ \
+    X(STORE_SLOT)    /* slots[a] = pop(), b je typ promenne (jen pro vypis) */ \
+    /* typy operandu zna prekladac (TypeChecker), VM je uz nekontroluje */  \
+    X(ADD_INT)   X(ADD_FLOAT)                                              \
+    X(SUB_INT)   X(SUB_FLOAT)                                              \
+    X(MUL_INT)   X(MUL_FLOAT)                                              \
+    X(DIV_INT)   X(DIV_FLOAT)                                              \
+    X(LT_INT)    X(LT_FLOAT)                                               \
+    X(LE_INT)    X(LE_FLOAT)                                               \
+    X(GT_INT)    X(GT_FLOAT)                                               \
+    X(GE_INT)    X(GE_FLOAT)                                               \
+    X(EQ_INT)    X(EQ_FLOAT)   X(EQ_BOOL)   X(EQ_STR)                      \
+    X(NE_INT)    X(NE_FLOAT)   X(NE_BOOL)   X(NE_STR)                      \
+    X(I2F)           /* vrchol zasobniku cele_cislo -> plout */            \
+    X(F2I)           /* vrchol zasobniku plout -> cele_cislo (orizne) */   \
+    X(JUMP)          /* ip = a */                                          \
+    X(JUMP_IF_FALSE) /* if (!pop()) ip = a */                              \
+    X(JUMP_IF_TRUE)  /* if (pop()) ip = a */                               \
+    X(PRINT)                                                               \
+    /* pocitane smycky: slots[a] += krok; if (slots[a] CMP frame[b]) ip = c */ \
+    /* krok je v nasledujicim EXTRA_ARG, oba operandy jsou cele_cislo */      \
+    X(FOR_LT)                                                              \
+    X(FOR_LE)                                                              \
+    X(FOR_GT)                                                              \
+    X(FOR_GE)                                                              \
+    X(FOR_NE)                                                              \
+    X(EXTRA_ARG)     /* dalsi operand predchozi instrukce, nevykonava se */ \
+    /* pole: prvky cele_cislo nebo plout, ARR_* a REDUCE_* vola kernely simd */ \
+    X(ARR_NEW)       /* vrchol (delka) -> nove pole nul, a je typ pole */  \
+    X(A2F)           /* vrchol pole cele_cislo -> pole plout */            \
+    X(A2I)           /* vrchol pole plout -> pole cele_cislo (orizne) */   \
+    X(ARR_INT)       /* po prvcich: a je BinOp, b je simd::Shape */        \
+    X(ARR_FLOAT)                                                           \
+    X(INDEX_INT)     /* pole, index -> prvek; mimo rozsah 0 */             \
+    X(INDEX_FLOAT)                                                         \
+    X(SET_ELEM_INT)  /* slots[a][index] = hodnota; mimo rozsah nic */      \
+    X(SET_ELEM_FLOAT)                                                      \
+    X(REDUCE_INT)    /* vrchol (pole) -> soucet/minimum/maximum, a je simd::Reduce */ \
+    X(REDUCE_FLOAT)                                                        \
+    X(LEN)           /* vrchol (pole) -> delka */                          \
+    /* slovniky: klic je cele_cislo nebo retezec, viz DictObj */             \
+    X(DICT_NEW)      /* vrchol (rezerva) -> prazdny slovnik, a je typ */   \
+    X(DICT_GET_INT)  /* slovnik, klic -> hodnota; chybejici klic 0 */      \
+    X(DICT_GET_FLOAT)                                                      \
+    X(DICT_SET_INT)  /* slots[a][klic] = hodnota; chybejici klic prida */  \
+    X(DICT_SET_FLOAT)                                                      \
+    X(DICT_HAS)      /* slovnik, klic -> boolean (obsahuje) */             \
+    X(DICT_LEN)      /* vrchol (slovnik) -> pocet polozek */               \
+    /* funkce: argumenty lezi na zasobniku a stanou se prvnimi sloty framu */ \
+    X(CALL)          /* zavola functions[a], b je pocet argumentu */       \
+    X(TAILCALL)      /* totez misto RET: nahradi frame volajici funkce */  \
+    X(RET)           /* vrati vrchol volajicimu, zahodi frame */           \
+    X(POP)           /* zahodi vrchol (vysledek volani jako prikazu) */    \
+    X(HALT)
+
+enum class Op : uint8_t {
+#define CZPP_OP_ENUM(name) name,
+    CZPP_OPCODES(CZPP_OP_ENUM)
+#undef CZPP_OP_ENUM
+};
+
+struct Instr {
+    Op op;
+    int32_t a = 0;
+    int32_t b = 0;
+    int32_t c = 0;
+};
+
+struct SrcPos {
+    uint32_t line = 0, col = 0;
+};
+
+// Instrukce [begin, end) jednoho prikazu vcetne vnorenych (pro profiler).
+struct StmtRange {
+    uint32_t line = 0;
+    int32_t begin = 0, end = 0;
+};
+
+// Funkce skriptu v Chunku, kod [entry, end) lezi za HALT programu.
+// Frame funkce je na zasobniku VM: parametry, lokalni promenne (sloty
+// jen teto funkce) a nad nimi operandy. Konstanty ve framu nema, mez
+// pocitane smycky je vzdy v lokalni promenne.
+struct FuncInfo {
+    std::string name;
+    int32_t entry = 0, end = 0;
+    int32_t params = 0;
+    Value::Type ret = Value::NONE;
+    std::vector<std::string> slotNames;
+    std::vector<Value::Type> slotTypes;
+    size_t maxStack = 0;
+
+    int32_t locals() const { return (int32_t)slotNames.size(); }
+    // kolik mist framu na zasobniku VM potrebuje (+1 pro vysledek)
+    size_t frameSize() const { return slotNames.size() + maxStack + 1; }
+};
+
+// Prelozeny program: plochy seznam instrukci a vse, na co odkazuji.
+// Frame VM obsahuje nejdriv promenne (slotNames) a za nimi kopie konstant,
+// aby instrukce FOR_* mohly mit mez v promenne i v literalu.
+struct Chunk {
+    std::vector<Instr> code;
+    std::vector<SrcPos> positions;       // pozice ve zdrojaku pro kazdou instrukci (chybove hlasky)
+    std::vector<StmtRange> stmts;        // vsechny prikazy v poradi prekladu
+    std::vector<Value> constants;
+    std::vector<std::string> slotNames;  // jmena promennych podle slotu
+    std::vector<Value::Type> slotTypes;  // staticky typ kazde promenne (cte ho JIT)
+    size_t maxStack = 0;
+    std::vector<FuncInfo> functions;     // podle FuncDef::index
+
+    int32_t constSlot(int32_t k) const { return (int32_t)slotNames.size() + k; }
+    size_t frameSize() const { return slotNames.size() + constants.size(); }
+};
+
+const char* opName(Op op);
+std::string disassemble(const Chunk& chunk);
+// posune cile skoku instrukce o delta (kod presunuty v ramci Chunku)
+void relocate(Instr& in, int32_t delta);
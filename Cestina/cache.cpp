@@ -0,0 +1,262 @@
+#include "cache.h"
+#include <cstring>
+#include "simd.h"
+
+// Hlavicka: magic, verze, pocet opkodu, flags, hash zdrojaku, soucet dat,
+// pocty prvku. Cisla jsou v poradi bajtu stroje, ktery cache zapsal;
+// jiny stroj ji odmitne uz na magic.
+static constexpr uint32_t Magic = 0x31425A43; // "CZB1"
+static constexpr uint32_t OpCount = (uint32_t)Op::HALT + 1;
+
+namespace {
+
+struct Header {
+    uint32_t magic, version, opCount, flags;
+    uint64_t hash, checksum;
+    uint32_t code, positions, stmts, constants, slots, maxStack, functions;
+};
+
+class Writer {
+public:
+    std::string out;
+    template <class T>
+    void put(const T& v) { out.append(reinterpret_cast<const char*>(&v), sizeof v); }
+    void bytes(std::string_view s) {
+        put((uint32_t)s.size());
+        out.append(s);
+    }
+};
+
+class Reader {
+public:
+    explicit Reader(std::string_view data) : data(data) {}
+    template <class T>
+    bool get(T& v) {
+        if (data.size() - pos < sizeof v) return false;
+        std::memcpy(&v, data.data() + pos, sizeof v);
+        pos += sizeof v;
+        return true;
+    }
+    bool bytes(std::string_view& s) {
+        uint32_t n;
+        if (!get(n) || data.size() - pos < n) return false;
+        s = data.substr(pos, n);
+        pos += n;
+        return true;
+    }
+    // pole pevne velikosti se kopiruje naraz
+    template <class T>
+    bool array(std::vector<T>& v, uint32_t n) {
+        if ((data.size() - pos) / sizeof(T) < n) return false;
+        v.resize(n);
+        std::memcpy(v.data(), data.data() + pos, n * sizeof(T));
+        pos += n * sizeof(T);
+        return true;
+    }
+    bool atEnd() const { return pos == data.size(); }
+
+private:
+    std::string_view data;
+    size_t pos = 0;
+};
+
+// Instr ma za op tri bajty vyplne; v souboru jsou nulove, at je obsah deterministicky.
+struct PackedInstr {
+    uint8_t op, pad[3];
+    int32_t a, b, c;
+};
+static_assert(sizeof(PackedInstr) == sizeof(Instr), "Instr a PackedInstr musi mit stejny tvar");
+
+// Operandy musi mirit dovnitr programu a framu, jinak by VM cetl mimo.
+// Program konci HALT, za nim jdou tesne za sebou funkce, kazda konci RET;
+// skoky nevedou ven z kodu, ve kterem jsou.
+bool verify(const Chunk& chunk) {
+    int32_t n = (int32_t)chunk.code.size();
+    int32_t main = chunk.functions.empty() ? n : chunk.functions[0].entry;
+    if (main <= 0 || main > n || chunk.code[main - 1].op != Op::HALT || chunk.positions.size() != chunk.code.size()) return false;
+    for (size_t f = 0; f < chunk.functions.size(); f++) {
+        const FuncInfo& fi = chunk.functions[f];
+        int32_t next = f + 1 < chunk.functions.size() ? chunk.functions[f + 1].entry : n;
+        if (fi.entry >= fi.end || fi.end != next || chunk.code[fi.end - 1].op != Op::RET) return false;
+        if (fi.params < 0 || fi.params > fi.locals() || fi.slotTypes.size() != fi.slotNames.size()) return false;
+    }
+    const FuncInfo* fn = nullptr;
+    int32_t lo = 0, hi = main;
+    int32_t vars = (int32_t)chunk.slotNames.size();
+    int32_t frame = (int32_t)chunk.frameSize();
+    for (int32_t k = 0; k < n; k++) {
+        if (k == hi) {
+            fn = fn ? fn + 1 : chunk.functions.data();
+            lo = fn->entry;
+            hi = fn->end;
+            vars = frame = fn->locals();
+        }
+        const Instr& in = chunk.code[k];
+        switch (in.op) {
+        case Op::PUSH_CONST:
+            if (in.a < 0 || (size_t)in.a >= chunk.constants.size()) return false;
+            break;
+        case Op::LOAD_SLOT:
+        case Op::DECL_SLOT:
+        case Op::STORE_SLOT:
+        case Op::SET_ELEM_INT:
+        case Op::SET_ELEM_FLOAT:
+        case Op::DICT_SET_INT:
+        case Op::DICT_SET_FLOAT:
+            if (in.a < 0 || in.a >= vars) return false;
+            break;
+        case Op::JUMP:
+        case Op::JUMP_IF_FALSE:
+        case Op::JUMP_IF_TRUE:
+            if (in.a < lo || in.a >= hi) return false;
+            break;
+        case Op::FOR_LT:
+        case Op::FOR_LE:
+        case Op::FOR_GT:
+        case Op::FOR_GE:
+        case Op::FOR_NE:
+            if (in.a < 0 || in.a >= vars || in.b < 0 || in.b >= frame || in.c < lo || in.c >= hi) return false;
+            if (k + 1 >= hi || chunk.code[k + 1].op != Op::EXTRA_ARG) return false;
+            break;
+        case Op::CALL:
+        case Op::TAILCALL:
+            if (in.a < 0 || (size_t)in.a >= chunk.functions.size() || in.b != chunk.functions[in.a].params) return false;
+            if (in.op == Op::TAILCALL && !fn) return false;
+            break;
+        case Op::RET:
+            if (!fn) return false;
+            break;
+        case Op::ARR_NEW:
+            if (in.a != Value::ARRAY_INT && in.a != Value::ARRAY_FLOAT) return false;
+            break;
+        case Op::DICT_NEW:
+            if (in.a != Value::DICT_INT && in.a != Value::DICT_FLOAT) return false;
+            break;
+        case Op::ARR_INT:
+        case Op::ARR_FLOAT:
+            if (in.a < (int32_t)BinOp::Add || in.a > (int32_t)BinOp::Div || in.b < simd::ArrArr || in.b > simd::ScalarArr) return false;
+            break;
+        case Op::REDUCE_INT:
+        case Op::REDUCE_FLOAT:
+            if (in.a < (int32_t)simd::Reduce::Sum || in.a > (int32_t)simd::Reduce::Max) return false;
+            break;
+        default:
+            if ((uint32_t)in.op >= OpCount) return false;
+            break;
+        }
+    }
+    for (const StmtRange& s : chunk.stmts)
+        if (s.begin < 0 || s.begin > s.end || s.end > n) return false;
+    return true;
+}
+
+} // namespace
+
+uint64_t sourceHash(std::string_view source) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char c : source) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+std::string writeCzb(const Chunk& chunk, uint64_t hash, uint32_t flags) {
+    Writer body;
+    for (const Instr& in : chunk.code) {
+        PackedInstr p{ (uint8_t)in.op, { 0, 0, 0 }, in.a, in.b, in.c };
+        body.put(p);
+    }
+    for (const SrcPos& p : chunk.positions) body.put(p);
+    for (const StmtRange& s : chunk.stmts) body.put(s);
+    for (const Value& v : chunk.constants) {
+        body.put((uint8_t)v.type);
+        if (v.type == Value::STRING) body.bytes(v.str());
+        else body.put(v.i);
+    }
+    for (size_t k = 0; k < chunk.slotNames.size(); k++) {
+        body.put((uint8_t)chunk.slotTypes[k]);
+        body.bytes(chunk.slotNames[k]);
+    }
+    for (const FuncInfo& f : chunk.functions) {
+        body.bytes(f.name);
+        body.put(f.entry);
+        body.put(f.end);
+        body.put(f.params);
+        body.put((uint8_t)f.ret);
+        body.put((uint32_t)f.maxStack);
+        body.put((uint32_t)f.slotNames.size());
+        for (size_t k = 0; k < f.slotNames.size(); k++) {
+            body.put((uint8_t)f.slotTypes[k]);
+            body.bytes(f.slotNames[k]);
+        }
+    }
+
+    Header h{ Magic, CzbVersion, OpCount, flags, hash, sourceHash(body.out),
+        (uint32_t)chunk.code.size(), (uint32_t)chunk.positions.size(), (uint32_t)chunk.stmts.size(),
+        (uint32_t)chunk.constants.size(), (uint32_t)chunk.slotNames.size(), (uint32_t)chunk.maxStack,
+        (uint32_t)chunk.functions.size() };
+    Writer file;
+    file.put(h);
+    file.out += body.out;
+    return std::move(file.out);
+}
+
+bool readCzb(std::string_view data, uint64_t hash, uint32_t flags, Chunk& out) {
+    Reader r(data);
+    Header h;
+    if (!r.get(h)) return false;
+    if (h.magic != Magic || h.version != CzbVersion || h.opCount != OpCount || h.flags != flags || h.hash != hash) return false;
+    if (h.checksum != sourceHash(data.substr(sizeof h))) return false;
+
+    Chunk c;
+    if (!r.array(c.code, h.code) || !r.array(c.positions, h.positions) || !r.array(c.stmts, h.stmts)) return false;
+    c.constants.reserve(h.constants);
+    for (uint32_t k = 0; k < h.constants; k++) {
+        uint8_t type;
+        if (!r.get(type)) return false;
+        if (type == Value::STRING) {
+            std::string_view s;
+            if (!r.bytes(s)) return false;
+            c.constants.push_back(Value::make_string(s));
+            continue;
+        }
+        long long bits;
+        if (type > Value::NONE || !r.get(bits)) return false;
+        Value v;
+        v.type = (Value::Type)type;
+        v.i = bits;
+        c.constants.push_back(v);
+    }
+    c.slotNames.reserve(h.slots);
+    c.slotTypes.reserve(h.slots);
+    for (uint32_t k = 0; k < h.slots; k++) {
+        uint8_t type;
+        std::string_view name;
+        if (!r.get(type) || type > Value::DICT_FLOAT || !r.bytes(name)) return false;
+        c.slotTypes.push_back((Value::Type)type);
+        c.slotNames.emplace_back(name);
+    }
+    for (uint32_t k = 0; k < h.functions; k++) {
+        FuncInfo f;
+        std::string_view name;
+        uint8_t ret;
+        uint32_t maxStack, slots;
+        if (!r.bytes(name) || !r.get(f.entry) || !r.get(f.end) || !r.get(f.params) || !r.get(ret) || !r.get(maxStack) || !r.get(slots)) return false;
+        if (ret > Value::DICT_FLOAT || ret == Value::STRING) return false;
+        f.name = name;
+        f.ret = (Value::Type)ret;
+        f.maxStack = maxStack;
+        for (uint32_t j = 0; j < slots; j++) {
+            uint8_t type;
+            if (!r.get(type) || type > Value::DICT_FLOAT || !r.bytes(name)) return false;
+            f.slotTypes.push_back((Value::Type)type);
+            f.slotNames.emplace_back(name);
+        }
+        c.functions.push_back(std::move(f));
+    }
+    c.maxStack = h.maxStack;
+    if (!r.atEnd() || !verify(c)) return false;
+    out = std::move(c);
+    return true;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "bytecode.h"
+
+// Soubor .czb: prelozeny Chunk, aby se casto spousteny skript nemusel
+// znovu lexovat a parsovat. Hlavicka nese verzi formatu, pocet opkodu,
+// hash zdrojaku, nastaveni prekladu a kontrolni soucet dat; cache, ktera
+// v cemkoli nesedi, se povazuje za zastaralou.
+constexpr uint32_t CzbVersion = 4;
+
+// FNV-1a 64 nad zdrojakem
+uint64_t sourceHash(std::string_view source);
+
+// serializovany Chunk vcetne hlavicky
+std::string writeCzb(const Chunk& chunk, uint64_t hash, uint32_t flags);
+
+// Nacte Chunk z obsahu .czb (typicky namapovaneho souboru). Vraci false,
+// pokud soubor neodpovida hash/flags, je z jine verze nebo je poskozeny.
+bool readCzb(std::string_view data, uint64_t hash, uint32_t flags, Chunk& out);
@@ -0,0 +1,362 @@
+#include "compiler.h"
+#include "simd.h"
+
+static bool isDict(Value::Type t) { return t == Value::DICT_INT || t == Value::DICT_FLOAT; }
+
+// Kolik hodnot instrukce ubere (zaporne) nebo prida na zasobnik.
+static int stackEffect(Op op) {
+    switch (op) {
+    case Op::PUSH_CONST:
+    case Op::LOAD_SLOT:
+        return 1;
+    case Op::I2F:
+    case Op::F2I:
+    case Op::JUMP:
+    case Op::FOR_LT:
+    case Op::FOR_LE:
+    case Op::FOR_GT:
+    case Op::FOR_GE:
+    case Op::FOR_NE:
+    case Op::EXTRA_ARG:
+    case Op::ARR_NEW:
+    case Op::A2F:
+    case Op::A2I:
+    case Op::REDUCE_INT:
+    case Op::REDUCE_FLOAT:
+    case Op::LEN:
+    case Op::DICT_NEW:
+    case Op::DICT_LEN:
+    case Op::HALT:
+        return 0;
+    case Op::SET_ELEM_INT:
+    case Op::SET_ELEM_FLOAT:
+    case Op::DICT_SET_INT:
+    case Op::DICT_SET_FLOAT:
+        return -2;
+    default:
+        // zapisy, skoky s podminkou, tiskni a vsechny binarni operace
+        return -1;
+    }
+}
+
+// Typove specializovana instrukce pro binarni operaci nad operandy typu t
+// (u smiseneho cele_cislo/plout uz prevedenymi na plout).
+static Op typedOp(BinOp op, Value::Type t) {
+    bool f = t == Value::FLOAT;
+    switch (op) {
+    case BinOp::Add: return f ? Op::ADD_FLOAT : Op::ADD_INT;
+    case BinOp::Sub: return f ? Op::SUB_FLOAT : Op::SUB_INT;
+    case BinOp::Mul: return f ? Op::MUL_FLOAT : Op::MUL_INT;
+    case BinOp::Div: return f ? Op::DIV_FLOAT : Op::DIV_INT;
+    case BinOp::Lt: return f ? Op::LT_FLOAT : Op::LT_INT;
+    case BinOp::Le: return f ? Op::LE_FLOAT : Op::LE_INT;
+    case BinOp::Gt: return f ? Op::GT_FLOAT : Op::GT_INT;
+    case BinOp::Ge: return f ? Op::GE_FLOAT : Op::GE_INT;
+    case BinOp::Eq: return f ? Op::EQ_FLOAT : t == Value::BOOL ? Op::EQ_BOOL : t == Value::STRING ? Op::EQ_STR : Op::EQ_INT;
+    case BinOp::Ne: return f ? Op::NE_FLOAT : t == Value::BOOL ? Op::NE_BOOL : t == Value::STRING ? Op::NE_STR : Op::NE_INT;
+    }
+    return Op::HALT;
+}
+
+int32_t Compiler::emit(Op op, uint32_t line, uint32_t col, int32_t a, int32_t b) {
+    Instr in;
+    in.op = op;
+    in.a = a;
+    in.b = b;
+    chunk.code.push_back(in);
+    chunk.positions.push_back({ line, col });
+    // volani ubere argumenty a prida vysledek
+    depth += op == Op::CALL ? 1 - b : op == Op::TAILCALL ? -b : stackEffect(op);
+    if ((size_t)depth > chunk.maxStack) chunk.maxStack = depth;
+    return here() - 1;
+}
+
+int32_t Compiler::constant(const Value& v) {
+    chunk.constants.push_back(v);
+    return (int32_t)chunk.constants.size() - 1;
+}
+
+Chunk Compiler::compile(const Block& program, const std::vector<SlotInfo>& slotInfo) {
+    chunk = Chunk();
+    slots = &slotInfo;
+    depth = 0;
+    for (const SlotInfo& si : slotInfo) {
+        chunk.slotNames.push_back(si.name);
+        chunk.slotTypes.push_back(si.type);
+    }
+    compileBlock(program);
+    emit(Op::HALT, 0, 0);
+    // funkce za programem
+    for (const StmtPtr& s : program.stmts)
+        if (s->kind == Stmt::Func && (size_t)s->func->index >= chunk.functions.size()) chunk.functions.resize(s->func->index + 1);
+    for (const StmtPtr& s : program.stmts)
+        if (s->kind == Stmt::Func) compileFunction(*s->func);
+    return std::move(chunk);
+}
+
+// Telo funkce s vlastnimi sloty a vlastni hloubkou zasobniku. Kdyz
+// skonci bez vrat, vrati nulovou hodnotu sveho typu.
+void Compiler::compileFunction(const FuncDef& f) {
+    FuncInfo& info = chunk.functions[f.index];
+    info.name = std::string(f.name);
+    info.params = (int32_t)f.params.size();
+    info.ret = f.ret;
+    for (const SlotInfo& si : f.slots) {
+        info.slotNames.push_back(si.name);
+        info.slotTypes.push_back(si.type);
+    }
+    const std::vector<SlotInfo>* outer = slots;
+    size_t outerStack = chunk.maxStack;
+    slots = &f.slots;
+    fn = &info;
+    chunk.maxStack = 0;
+    depth = 0;
+
+    info.entry = here();
+    compileBlock(f.body);
+    pushDefault(f.ret, f.line, f.col);
+    emit(Op::RET, f.line, f.col);
+    info.end = here();
+    info.maxStack = chunk.maxStack;
+    // radek hlavicky pocita vstupy do funkce a cely cas v ni (profiler)
+    chunk.stmts.push_back({ f.line, info.entry, info.end });
+
+    chunk.maxStack = outerStack;
+    slots = outer;
+    fn = nullptr;
+}
+
+// nulova hodnota typu (i prazdne pole a slovnik) na zasobnik; NONE u funkce bez typu
+void Compiler::pushDefault(Value::Type type, uint32_t line, uint32_t col) {
+    switch (type) {
+    case Value::ARRAY_INT:
+    case Value::ARRAY_FLOAT:
+    case Value::DICT_INT:
+    case Value::DICT_FLOAT:
+        emit(Op::PUSH_CONST, line, col, constant(Value::make_int(0)));
+        emit(isDict(type) ? Op::DICT_NEW : Op::ARR_NEW, line, col, type);
+        return;
+    case Value::INT: emit(Op::PUSH_CONST, line, col, constant(Value::make_int(0))); return;
+    case Value::FLOAT: emit(Op::PUSH_CONST, line, col, constant(Value::make_float(0.0))); return;
+    case Value::BOOL: emit(Op::PUSH_CONST, line, col, constant(Value::make_bool(false))); return;
+    default: emit(Op::PUSH_CONST, line, col, constant(Value())); return;
+    }
+}
+
+// argumenty volani funkce skriptu, prevedene na typy parametru
+void Compiler::compileArgs(const Expr& call) {
+    const ArenaList<Param>& params = call.func->params;
+    for (size_t k = 0; k < call.args.size(); k++) {
+        compileExpr(*call.args[k]);
+        convert(call.args[k]->type, params[k].type, call.args[k]->line, call.args[k]->col);
+    }
+}
+
+void Compiler::compileExpr(const Expr& e) {
+    switch (e.kind) {
+    case Expr::Literal:
+        emit(Op::PUSH_CONST, e.line, e.col, constant(e.value));
+        return;
+    case Expr::Var:
+        emit(Op::LOAD_SLOT, e.line, e.col, e.slot);
+        return;
+    case Expr::Binary: {
+        if (e.type == Value::ARRAY_INT || e.type == Value::ARRAY_FLOAT) {
+            compileArrayBinary(e);
+            return;
+        }
+        // cele_cislo s plout se pocita v plout, prevede se hned po vycisleni operandu
+        Value::Type l = e.lhs->type, r = e.rhs->type;
+        Value::Type t = l == Value::FLOAT || r == Value::FLOAT ? Value::FLOAT : l;
+        compileExpr(*e.lhs);
+        convert(l, t, e.line, e.col);
+        compileExpr(*e.rhs);
+        convert(r, t, e.line, e.col);
+        emit(typedOp(e.op, t), e.line, e.col);
+        return;
+    }
+    case Expr::Index: {
+        compileExpr(*e.lhs);
+        compileExpr(*e.rhs);
+        bool f = e.type == Value::FLOAT;
+        if (isDict(e.lhs->type)) emit(f ? Op::DICT_GET_FLOAT : Op::DICT_GET_INT, e.line, e.col);
+        else emit(f ? Op::INDEX_FLOAT : Op::INDEX_INT, e.line, e.col);
+        return;
+    }
+    case Expr::Call: {
+        if (e.fn == Builtin::User) {
+            compileArgs(e);
+            emit(Op::CALL, e.line, e.col, e.func->index, (int32_t)e.args.size());
+            return;
+        }
+        compileExpr(*e.lhs);
+        if (e.fn == Builtin::Obsahuje) {
+            compileExpr(*e.rhs);
+            emit(Op::DICT_HAS, e.line, e.col);
+            return;
+        }
+        if (e.fn == Builtin::Delka) {
+            emit(isDict(e.lhs->type) ? Op::DICT_LEN : Op::LEN, e.line, e.col);
+            return;
+        }
+        simd::Reduce r = e.fn == Builtin::Soucet ? simd::Reduce::Sum : e.fn == Builtin::Minimum ? simd::Reduce::Min : simd::Reduce::Max;
+        emit(e.type == Value::INT ? Op::REDUCE_INT : Op::REDUCE_FLOAT, e.line, e.col, (int32_t)r);
+        return;
+    }
+    }
+}
+
+// Aritmetika po prvcich. Je-li nektery operand plout, prevede se druhy
+// (cislo i pole) na plout uz pred operaci, stejne jako u skalaru.
+void Compiler::compileArrayBinary(const Expr& e) {
+    Value::Type l = e.lhs->type, r = e.rhs->type;
+    bool f = e.type == Value::ARRAY_FLOAT;
+    bool la = l == Value::ARRAY_INT || l == Value::ARRAY_FLOAT;
+    bool ra = r == Value::ARRAY_INT || r == Value::ARRAY_FLOAT;
+    compileExpr(*e.lhs);
+    if (f) convert(l, la ? Value::ARRAY_FLOAT : Value::FLOAT, e.line, e.col);
+    compileExpr(*e.rhs);
+    if (f) convert(r, ra ? Value::ARRAY_FLOAT : Value::FLOAT, e.line, e.col);
+    simd::Shape shape = la && ra ? simd::ArrArr : la ? simd::ArrScalar : simd::ScalarArr;
+    emit(f ? Op::ARR_FLOAT : Op::ARR_INT, e.line, e.col, (int32_t)e.op, shape);
+}
+
+// prevod hodnoty na vrcholu zasobniku mezi cele_cislo a plout (i u poli)
+void Compiler::convert(Value::Type from, Value::Type to, uint32_t line, uint32_t col) {
+    if (from == Value::INT && to == Value::FLOAT) emit(Op::I2F, line, col);
+    else if (from == Value::FLOAT && to == Value::INT) emit(Op::F2I, line, col);
+    else if (from == Value::ARRAY_INT && to == Value::ARRAY_FLOAT) emit(Op::A2F, line, col);
+    else if (from == Value::ARRAY_FLOAT && to == Value::ARRAY_INT) emit(Op::A2I, line, col);
+}
+
+// definice funkci preklada compileFunction, v toku programu nic nedelaji
+void Compiler::compileBlock(const Block& block) {
+    for (const StmtPtr& s : block.stmts)
+        if (s->kind != Stmt::Func) compileStmt(*s);
+}
+
+void Compiler::compileStmt(const Stmt& s) {
+    int32_t begin = here();
+    emitStmt(s);
+    chunk.stmts.push_back({ s.line, begin, here() });
+}
+
+void Compiler::emitStmt(const Stmt& s) {
+    switch (s.kind) {
+    case Stmt::Decl:
+        if (s.expr) {
+            compileExpr(*s.expr);
+            convert(s.expr->type, s.declType, s.line, s.col);
+        }
+        else if (s.index) {
+            compileExpr(*s.index);
+            emit(isDict(s.declType) ? Op::DICT_NEW : Op::ARR_NEW, s.line, s.col, s.declType);
+        }
+        else pushDefault(s.declType, s.line, s.col); // pole bez velikosti je prazdne, slovnik bez rezervy taky
+        emit(Op::DECL_SLOT, s.line, s.col, s.slot, s.declType);
+        return;
+    case Stmt::Assign:
+        compileExpr(*s.expr);
+        convert(s.expr->type, (*slots)[s.slot].type, s.line, s.col);
+        emit(Op::STORE_SLOT, s.line, s.col, s.slot, (*slots)[s.slot].type);
+        return;
+    case Stmt::SetIndex: {
+        Value::Type t = (*slots)[s.slot].type;
+        bool f = t == Value::ARRAY_FLOAT || t == Value::DICT_FLOAT;
+        compileExpr(*s.index);
+        compileExpr(*s.expr);
+        convert(s.expr->type, f ? Value::FLOAT : Value::INT, s.line, s.col);
+        if (isDict(t)) emit(f ? Op::DICT_SET_FLOAT : Op::DICT_SET_INT, s.line, s.col, s.slot);
+        else emit(f ? Op::SET_ELEM_FLOAT : Op::SET_ELEM_INT, s.line, s.col, s.slot);
+        return;
+    }
+    case Stmt::Print:
+        compileExpr(*s.expr);
+        emit(Op::PRINT, s.line, s.col);
+        return;
+    case Stmt::If: {
+        compileExpr(*s.expr);
+        int32_t toElse = emit(Op::JUMP_IF_FALSE, s.line, s.col);
+        compileBlock(s.body);
+        if (s.hasElse) {
+            int32_t toEnd = emit(Op::JUMP, s.line, s.col);
+            patch(toElse, here());
+            compileBlock(s.elseBody);
+            patch(toEnd, here());
+        }
+        else patch(toElse, here());
+        return;
+    }
+    case Stmt::While: {
+        if (s.step != 0) {
+            compileCountedLoop(s);
+            return;
+        }
+        // podminka je az za telem, kazda iterace tak stoji jen jeden skok
+        int32_t toCond = emit(Op::JUMP, s.line, s.col);
+        int32_t body = here();
+        compileBlock(s.body);
+        patch(toCond, here());
+        compileExpr(*s.expr);
+        emit(Op::JUMP_IF_TRUE, s.line, s.col, body);
+        return;
+    }
+    case Stmt::Return: {
+        const Expr* e = s.expr;
+        if (e && e->kind == Expr::Call && e->fn == Builtin::User && e->type == fn->ret) {
+            // volani na konci funkce prevezme jeji frame, rekurze tak nezabira zasobnik
+            compileArgs(*e);
+            emit(Op::TAILCALL, s.line, s.col, e->func->index, (int32_t)e->args.size());
+            return;
+        }
+        if (e) {
+            compileExpr(*e);
+            convert(e->type, fn->ret, s.line, s.col);
+        }
+        else pushDefault(Value::NONE, s.line, s.col);
+        emit(Op::RET, s.line, s.col);
+        return;
+    }
+    case Stmt::Eval:
+        compileExpr(*s.expr);
+        emit(Op::POP, s.line, s.col);
+        return;
+    case Stmt::Func:
+        return;
+    }
+}
+
+// zatimco (i CMP mez) { ...; i = i + krok }, viz LoopOptimizer.
+// Podminka se vyhodnoti jednou pred vstupem, na konci tela pak jedina
+// instrukce FOR_* pricte krok, porovna a skoci.
+void Compiler::compileCountedLoop(const Stmt& s) {
+    const Expr& cond = *s.expr;
+    int32_t limit = cond.rhs->kind == Expr::Var ? cond.rhs->slot : -1;
+    if (limit < 0 && !fn) limit = chunk.constSlot(constant(cond.rhs->value));
+    else if (limit < 0) {
+        // frame funkce nema kopie konstant, mez dostane vlastni slot
+        limit = fn->locals();
+        fn->slotNames.push_back("$mez" + std::to_string(limit));
+        fn->slotTypes.push_back(Value::INT);
+        emit(Op::PUSH_CONST, s.line, s.col, constant(cond.rhs->value));
+        emit(Op::DECL_SLOT, s.line, s.col, limit, Value::INT);
+    }
+    compileExpr(cond);
+    int32_t toExit = emit(Op::JUMP_IF_FALSE, s.line, s.col);
+    int32_t body = here();
+    for (size_t k = 0; k + 1 < s.body.stmts.size(); k++) compileStmt(*s.body.stmts[k]);
+    Op op = Op::FOR_NE;
+    switch (cond.op) {
+    case BinOp::Lt: op = Op::FOR_LT; break;
+    case BinOp::Le: op = Op::FOR_LE; break;
+    case BinOp::Gt: op = Op::FOR_GT; break;
+    case BinOp::Ge: op = Op::FOR_GE; break;
+    default: break;
+    }
+    const Stmt& inc = *s.body.stmts.back();
+    int32_t at = emit(op, inc.line, inc.col, cond.lhs->slot, limit);
+    chunk.code[at].c = body;
+    emit(Op::EXTRA_ARG, inc.line, inc.col, s.step);
+    chunk.stmts.push_back({ inc.line, at, here() });
+    patch(toExit, here());
+}
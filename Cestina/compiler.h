@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include "ast.h"
+#include "bytecode.h"
+
+// Prekladac AST -> bytecode pro zasobnikovy VM.
+class Compiler {
+public:
+    // program uz musi projit Resolverem, ktery vratil slots, a TypeCheckerem
+    Chunk compile(const Block& program, const std::vector<SlotInfo>& slots);
+
+private:
+    Chunk chunk;
+    const std::vector<SlotInfo>* slots = nullptr;
+    FuncInfo* fn = nullptr; // prave prekladana funkce (nullptr = program)
+    int depth = 0;
+
+    int32_t emit(Op op, uint32_t line, uint32_t col, int32_t a = 0, int32_t b = 0);
+    void patch(int32_t at, int32_t target) { chunk.code[at].a = target; }
+    int32_t here() const { return (int32_t)chunk.code.size(); }
+    int32_t constant(const Value& v);
+    void convert(Value::Type from, Value::Type to, uint32_t line, uint32_t col);
+    void pushDefault(Value::Type type, uint32_t line, uint32_t col);
+
+    void compileExpr(const Expr& e);
+    void compileArrayBinary(const Expr& e);
+    void compileArgs(const Expr& call);
+    void compileFunction(const FuncDef& f);
+    void compileStmt(const Stmt& s);
+    void emitStmt(const Stmt& s);
+    void compileBlock(const Block& block);
+    void compileCountedLoop(const Stmt& s);
+};
@@ -0,0 +1,216 @@
+#include "value.h"
+#include <bit>
+#include <new>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CZPP_DICT_SSE2 1
+#endif
+
+// Skupina 16 ctrl bajtu. SSE2 je soucasti kazdeho x86-64, vyber za behu
+// jako v simd.h by tu stal vic nez samotne porovnani; jinde po bajtech.
+static const uint8_t Empty = 0x80;
+static const uint32_t GroupSize = 16;
+
+#ifdef CZPP_DICT_SSE2
+struct Group {
+    __m128i c;
+    explicit Group(const uint8_t* p) : c(_mm_load_si128(reinterpret_cast<const __m128i*>(p))) {}
+    // bit k = slot k ma ctrl bajt tag
+    uint32_t match(uint8_t tag) const { return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8((char)tag))); }
+    // bit k = slot k je prazdny (jen Empty ma horni bit)
+    uint32_t empty() const { return (uint32_t)_mm_movemask_epi8(c); }
+};
+#else
+struct Group {
+    const uint8_t* c;
+    explicit Group(const uint8_t* p) : c(p) {}
+    uint32_t match(uint8_t tag) const {
+        uint32_t m = 0;
+        for (uint32_t k = 0; k < GroupSize; k++) m |= (uint32_t)(c[k] == tag) << k;
+        return m;
+    }
+    uint32_t empty() const { return match(Empty); }
+};
+#endif
+
+// Nejnizsi bit rika, jestli je klic retezec (viz DictEntry), skupinu urci
+// bity od prvniho a ctrl bajt hornich 7 bitu.
+static uint64_t hashInt(long long k) {
+    uint64_t x = (uint64_t)k;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x & ~1ull;
+}
+
+static uint64_t keyHash(const Value& key) {
+    return key.type == Value::STRING ? key.s->hash : hashInt(key.i);
+}
+
+static uint8_t tagOf(uint64_t hash) { return (uint8_t)(hash >> 57); }
+
+// tabulka se plni nejvys do 7/8, skupina tedy unese 14 polozek
+static size_t groupsFor(size_t n) {
+    size_t g = 1;
+    while (g * 14 < n) g *= 2;
+    return g;
+}
+
+static size_t tableBytes(size_t groups) { return groups * GroupSize * (1 + sizeof(uint32_t)); }
+
+// Polozky jsou vzdy v jedne alokaci a nejvys 2^30, index se vejde do uint32_t.
+static const size_t MaxEntries = (size_t)1 << 30;
+
+static DictEntry* allocEntries(size_t n) {
+    if (n > MaxEntries) throw std::bad_alloc();
+    DictEntry* e = static_cast<DictEntry*>(::operator new(n * sizeof(DictEntry)));
+    countHeapBytes((int64_t)(n * sizeof(DictEntry)));
+    return e;
+}
+
+static void freeEntries(DictEntry* e, size_t n) {
+    countHeapBytes(-(int64_t)(n * sizeof(DictEntry)));
+    ::operator delete(e);
+}
+
+// ctrl a index v jedne alokaci, ctrl zarovnany na skupinu
+static uint8_t* allocTable(size_t groups) {
+    uint8_t* t = static_cast<uint8_t*>(::operator new(tableBytes(groups), std::align_val_t(GroupSize)));
+    countHeapBytes((int64_t)tableBytes(groups));
+    std::memset(t, Empty, groups * GroupSize);
+    return t;
+}
+
+static void freeTable(uint8_t* t, size_t groups) {
+    if (!t) return;
+    countHeapBytes(-(int64_t)tableBytes(groups));
+    ::operator delete(t, std::align_val_t(GroupSize));
+}
+
+DictObj* DictObj::make(size_t capacity) {
+    DictObj* o = new DictObj(); // vynulovany
+    o->refs = 1;
+    if (capacity) {
+        try { o->reserve(capacity); }
+        catch (...) { destroy(o); throw; }
+    }
+    return o;
+}
+
+// Stejna tabulka i rezerva, polozky se jen zkopiruji; retezcove klice
+// jsou sdilene.
+DictObj* DictObj::clone(const DictObj* src) {
+    DictObj* o = make(0);
+    try {
+        if (src->reserved) o->entries = allocEntries(src->reserved);
+        o->reserved = src->reserved;
+        if (src->groups) o->ctrl = allocTable(src->groups);
+        o->groups = src->groups;
+    }
+    catch (...) { destroy(o); throw; }
+    if (o->ctrl) {
+        std::memcpy(o->ctrl, src->ctrl, tableBytes(src->groups));
+        o->index = reinterpret_cast<uint32_t*>(o->ctrl + src->groups * GroupSize);
+    }
+    if (src->len) std::memcpy(o->entries, src->entries, src->len * sizeof(DictEntry));
+    o->len = src->len;
+    for (uint32_t k = 0; k < o->len; k++)
+        if (o->entries[k].hash & 1) o->entries[k].key.s->refs++;
+    return o;
+}
+
+void DictObj::destroy(DictObj* o) {
+    for (uint32_t k = 0; k < o->len; k++) {
+        StrObj* s = o->entries[k].key.s;
+        if ((o->entries[k].hash & 1) && --s->refs == 0) StrObj::destroy(s);
+    }
+    if (o->entries) freeEntries(o->entries, o->reserved);
+    freeTable(o->ctrl, o->groups);
+    delete o;
+}
+
+// Skupiny se prochazi trojuhelnikove (posun 1, 2, 3, ...), pri poctu
+// skupin mocnine 2 tak dojde na kazdou. Tabulka je plna nejvys ze 7/8,
+// prazdny slot se vzdy najde.
+const DictEntry* DictObj::probe(uint64_t hash, const Value& key) const {
+    uint8_t tag = tagOf(hash);
+    size_t mask = groups - 1;
+    size_t g = (size_t)(hash >> 1) & mask;
+    for (size_t step = 1;; step++) {
+        Group grp(ctrl + g * GroupSize);
+        for (uint32_t m = grp.match(tag); m; m &= m - 1) {
+            const DictEntry& e = entries[index[g * GroupSize + std::countr_zero(m)]];
+            if (e.hash != hash) continue;
+            if (!(hash & 1)) { if (e.key.i == key.i) return &e; }
+            else if (e.key.s == key.s || e.key.s->view() == key.str()) return &e;
+        }
+        if (grp.empty()) return nullptr;
+        g = (g + step) & mask;
+    }
+}
+
+const DictEntry* DictObj::find(const Value& key) const {
+    return groups ? probe(keyHash(key), key) : nullptr;
+}
+
+// prvni prazdny slot v posloupnosti skupin hashe
+static void place(uint8_t* ctrl, uint32_t* index, size_t groups, uint64_t hash, uint32_t entry) {
+    size_t mask = groups - 1;
+    size_t g = (size_t)(hash >> 1) & mask;
+    for (size_t step = 1;; step++) {
+        uint32_t m = Group(ctrl + g * GroupSize).empty();
+        if (m) {
+            size_t at = g * GroupSize + std::countr_zero(m);
+            ctrl[at] = tagOf(hash);
+            index[at] = entry;
+            return;
+        }
+        g = (g + step) & mask;
+    }
+}
+
+// Nova tabulka z ulozenych hashu, klice se znovu nehashuji.
+void DictObj::rehash(uint32_t newGroups) {
+    uint8_t* t = allocTable(newGroups);
+    uint32_t* idx = reinterpret_cast<uint32_t*>(t + (size_t)newGroups * GroupSize);
+    for (uint32_t k = 0; k < len; k++) place(t, idx, newGroups, entries[k].hash, k);
+    freeTable(ctrl, groups);
+    ctrl = t;
+    index = idx;
+    groups = newGroups;
+}
+
+void DictObj::reserve(size_t n) {
+    if (n > MaxEntries) throw std::bad_alloc();
+    if (n > reserved) {
+        DictEntry* e = allocEntries(n);
+        if (len) std::memcpy(e, entries, len * sizeof(DictEntry));
+        if (entries) freeEntries(entries, reserved);
+        entries = e;
+        reserved = (uint32_t)n;
+    }
+    size_t g = groupsFor(n);
+    if (g > groups) rehash((uint32_t)g);
+}
+
+DictEntry* DictObj::insert(const Value& key) {
+    uint64_t hash = keyHash(key);
+    if (groups) {
+        if (const DictEntry* e = probe(hash, key)) return const_cast<DictEntry*>(e);
+    }
+    // polozky rostou zdvojenim a tabulka s nimi (reserve)
+    if (len == reserved) reserve(reserved ? (size_t)reserved * 2 : 4);
+    DictEntry& e = entries[len];
+    e.hash = hash;
+    if (key.type == Value::STRING) {
+        e.key.s = key.s;
+        key.s->refs++;
+    }
+    else e.key.i = key.i;
+    e.value.i = 0;
+    place(ctrl, index, groups, hash, len);
+    len++;
+    return &e;
+}
@@ -1,357 +1,398 @@
 #include "interpreter.h"
-#include <cctype>
-#include <sstream>
-#include <cmath>
-/*
-std::string Value::toString() const {
-    switch (type) {
-    case INT: return std::to_string(i);
-    case FLOAT: {
-        std::ostringstream ss; ss << f; return ss.str();
-    }
-    case BOOL: return b ? "true" : "false";
-    default: return "none";
-    }
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "cache.h"
+#include "compiler.h"
+#include "lexer.h"
+#include "optimizer.h"
+#include "parser.h"
+#include "profile.h"
+#include "resolver.h"
+#include "source.h"
+#include "transpile.h"
+#include "typecheck.h"
+#include "vm.h"
+
+// Hlavicka funkce z predchoziho behu REPL: kdo ji vola, potrebuje jen typy.
+struct Signature {
+    std::string name;
+    Value::Type ret = Value::NONE;
+    std::vector<Value::Type> params;
+    uint32_t line = 0, col = 0;
+};
+
+// Stav inkrementalniho behu: sloty a jmena nejvyssi urovne, hodnoty
+// promennych a funkce z minulych behu. Funkce se znovu neprekladaji,
+// novy kod se jen navaze na jejich hlavicky a prelozeny kod v library
+// (Chunk jen s funkcemi, adresy od nuly).
+struct Interpreter::Session {
+    Resolver::Globals globals;
+    std::vector<Value> vars;
+    std::vector<Signature> functions;
+    Chunk library;
+};
+
+Interpreter::Interpreter() : session(std::make_unique<Session>()) {}
+Interpreter::~Interpreter() = default;
+
+// zdrojak -> tokeny -> AST (sloty, typy) -> bytecode
+Chunk Interpreter::compileSource(std::string_view code) {
+    ArenaScope scope(arena);
+    std::vector<Token> toks = tokenize(code);
+    Block program = Parser(toks, arena).parseProgram();
+    std::vector<SlotInfo> slots = Resolver().resolve(program);
+    TypeChecker().check(program, slots);
+    if (optimize) Optimizer(arena).optimize(program, slots);
+    return Compiler().compile(program, slots);
 }
-*/
-Interpreter::Interpreter() {}
 
-std::string Interpreter::run(const std::string& code) {
-    src = code;
-    pos = 0;
-    output.clear();
-    vars.clear();
-    try {
-        parseStatements();
+// Kod funkci z minulych behu se vlozi za HALT programu, pred nove funkce,
+// at funkce lezi v poradi indexu jako v programu prelozenem najednou. Pak se
+// z chunku znovu vyrizne library pro dalsi beh, uz i s novymi funkcemi.
+static void link(Chunk& chunk, Chunk& library, size_t known) {
+    int32_t main = known < chunk.functions.size() ? chunk.functions[known].entry : (int32_t)chunk.code.size();
+    int32_t shift = (int32_t)library.code.size();
+    int32_t base = (int32_t)chunk.constants.size();
+    for (size_t k = (size_t)main; k < chunk.code.size(); k++) relocate(chunk.code[k], shift);
+    for (size_t f = known; f < chunk.functions.size(); f++) {
+        chunk.functions[f].entry += shift;
+        chunk.functions[f].end += shift;
     }
-    catch (const std::string& e) {
-        output += std::string("Chyba: ") + e + "           ";
+    for (StmtRange& r : chunk.stmts)
+        if (r.begin >= main) { r.begin += shift; r.end += shift; }
+    chunk.code.insert(chunk.code.begin() + main, library.code.begin(), library.code.end());
+    chunk.positions.insert(chunk.positions.begin() + main, library.positions.begin(), library.positions.end());
+    for (int32_t k = main; k < main + shift; k++) {
+        Instr& in = chunk.code[k];
+        relocate(in, main);
+        if (in.op == Op::PUSH_CONST) in.a += base;
+    }
+    chunk.constants.insert(chunk.constants.end(), library.constants.begin(), library.constants.end());
+    for (StmtRange r : library.stmts) chunk.stmts.push_back({ r.line, r.begin + main, r.end + main });
+    if (chunk.functions.size() < library.functions.size()) chunk.functions.resize(library.functions.size());
+    for (size_t f = 0; f < library.functions.size(); f++) {
+        FuncInfo& fi = chunk.functions[f] = library.functions[f];
+        fi.entry += main;
+        fi.end += main;
     }
-    return output;
-}
 
-void Interpreter::skipSpaces() {
-    while (pos < src.size() && std::isspace((unsigned char)src[pos])) pos++;
+    // konstanty novych funkci se pridaji za konstanty knihovny
+    library.code.assign(chunk.code.begin() + main, chunk.code.end());
+    library.positions.assign(chunk.positions.begin() + main, chunk.positions.end());
+    for (Instr& in : library.code) {
+        relocate(in, -main);
+        if (in.op != Op::PUSH_CONST) continue;
+        if (in.a >= base) in.a -= base;
+        else {
+            library.constants.push_back(chunk.constants[in.a]);
+            in.a = (int32_t)library.constants.size() - 1;
+        }
+    }
+    library.stmts.clear();
+    for (StmtRange r : chunk.stmts)
+        if (r.begin >= main) library.stmts.push_back({ r.line, r.begin - main, r.end - main });
+    library.functions = chunk.functions;
+    for (FuncInfo& fi : library.functions) {
+        fi.entry -= main;
+        fi.end -= main;
+    }
 }
 
-bool Interpreter::startsWith(const std::string& s) {
-    skipSpaces();
-    return src.substr(pos, s.size()) == s;
+// Jako compileSource, ale navazuje na next.globals a doplni do nich nove
+// promenne. Promenne nejvyssi urovne se mohou cist v dalsim behu, proto je
+// optimalizator nesmi odstranit. Funkce z minulych behu znaji Resolver
+// a TypeChecker jen z hlavicek, jejich kod prida link().
+Chunk Interpreter::compileIncremental(std::string_view code, Session& next, uint32_t firstLine) {
+    ArenaScope scope(arena);
+    std::vector<FuncDef*> known;
+    for (const Signature& sig : next.functions) {
+        FuncDef* f = arena.make<FuncDef>();
+        f->name = arena.intern(sig.name);
+        f->ret = sig.ret;
+        f->index = (int32_t)known.size();
+        f->line = sig.line;
+        f->col = sig.col;
+        std::vector<Param> params(sig.params.size());
+        for (size_t k = 0; k < params.size(); k++) params[k].type = sig.params[k];
+        f->params = arena.list(params.data(), params.size());
+        known.push_back(f);
+    }
+    std::vector<Token> toks = tokenize(code, firstLine);
+    Block program = Parser(toks, arena).parseProgram();
+    std::vector<SlotInfo> slots = Resolver().resolve(program, next.globals, known);
+    TypeChecker().check(program, slots);
+    if (optimize) {
+        std::vector<int32_t> live;
+        for (const auto& entry : next.globals.names) live.push_back(entry.second);
+        Optimizer(arena).optimize(program, slots, live);
+    }
+    next.globals.slots = slots;
+    Chunk chunk = Compiler().compile(program, slots);
+    for (StmtPtr s : program.stmts) {
+        if (s->kind != Stmt::Func) continue;
+        const FuncDef& f = *s->func;
+        Signature sig{ std::string(f.name), f.ret, {}, f.line, f.col };
+        for (const Param& p : f.params) sig.params.push_back(p.type);
+        next.functions.push_back(std::move(sig));
+    }
+    link(chunk, next.library, known.size());
+    return chunk;
 }
 
-bool Interpreter::consumeIf(const std::string& s) {
-    skipSpaces();
-    if (src.substr(pos, s.size()) == s) { pos += s.size(); return true; }
-    return false;
+static void writeError(OutputSink& sink, const std::string& e) {
+    sink.write("Chyba: ");
+    sink.write(e);
+    sink.write("           ");
 }
 
-void Interpreter::expect(const std::string& s) {
-    skipSpaces();
-    if (src.substr(pos, s.size()) != s) throw std::string("Ocekavano '") + s + "'";
-    pos += s.size();
+// Prekroceny limit se hlasi stejne jako chyba programu.
+static void reportLimit(const VM& vm, Interpreter::RunStats& stats, OutputSink& sink) {
+    if (vm.limitHit() == LimitHit::None) return;
+    stats.limit = vm.limitHit();
+    stats.failed = true;
+    writeError(sink, limitMessage(stats.limit));
 }
 
-std::string Interpreter::parseIdent() {
-    skipSpaces();
-
-    size_t start = pos;
-    if (pos < src.size() && (std::isalpha((unsigned char)src[pos]) || src[pos] == '_')) {
-        pos++;
-        while (pos < src.size() && (std::isalnum((unsigned char)src[pos]) || src[pos] == '_')) pos++;
-        return src.substr(start, pos - start);
+std::string Interpreter::run(std::string_view code) {
+    std::string output;
+    {
+        StringSink sink(output);
+        run(code, sink);
     }
-    throw std::string("Ocekavan identifikator");
+    return output;
 }
 
-double Interpreter::parseNumber() {
-    skipSpaces();
-    size_t start = pos;
-    bool dot = false;
-    if (pos < src.size() && (src[pos] == '+' || src[pos] == '-')) pos++;
-    while (pos < src.size() && (std::isdigit((unsigned char)src[pos]) || src[pos] == '.')) {
-        if (src[pos] == '.') dot = true;
-        pos++;
+void Interpreter::run(std::string_view code, OutputSink& sink) {
+    using Clock = std::chrono::steady_clock;
+    stats = RunStats();
+    Clock::time_point start = Clock::now();
+    try {
+        Chunk chunk = compileSource(code);
+        stats.compile = std::chrono::duration<double>(Clock::now() - start).count();
+        runChunk(chunk, sink);
     }
-    std::string tok = src.substr(start, pos - start);
-    if (tok.empty()) throw std::string("Ocekavano cislo");
-    return std::stod(tok);
-}
-
-// Expr := Term { (+|-) Term }
-Value Interpreter::parseExpression() {
-    Value v = parseTerm();
-    while (true) {
-        skipSpaces();
-        if (pos < src.size() && (src[pos] == '+' || src[pos] == '-')) {
-            char op = src[pos++];
-            Value r = parseTerm();
-            // promote to float if needed
-            if (v.type == Value::FLOAT || r.type == Value::FLOAT) {
-                double lv = (v.type == Value::FLOAT) ? v.f : (v.type == Value::INT ? (double)v.i : 0.0);
-                double rv = (r.type == Value::FLOAT) ? r.f : (r.type == Value::INT ? (double)r.i : 0.0);
-                v = Value::make_float(op == '+' ? lv + rv : lv - rv);
-            }
-            else {
-                long long lv = v.i; long long rv = r.i;
-                v = Value::make_int(op == '+' ? lv + rv : lv - rv);
-            }
-        }
-        else break;
+    catch (const std::string& e) {
+        stats.failed = true;
+        writeError(sink, e);
     }
-    return v;
+    sink.flush();
 }
 
-// Term := Factor { (*|/) Factor }
-Value Interpreter::parseTerm() {
-    Value v = parseFactor();
-    while (true) {
-        skipSpaces();
-        if (pos < src.size() && src[pos] == '(') { pos++; Value v = parseExpression(); expect(")"); return v; }
+void Interpreter::runChunk(const Chunk& chunk, OutputSink& sink) {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    VM vm(sink);
+    vm.setJit(jit);
+    vm.setLimits(limits);
+    vm.run(chunk);
+    reportLimit(vm, stats, sink);
+    stats.execute = std::chrono::duration<double>(Clock::now() - start).count();
+}
 
-        if (pos < src.size() && (src[pos] == '*' || src[pos] == '/')) {
-            char op = src[pos++];
-            Value r = parseFactor();
-            if (v.type == Value::FLOAT || r.type == Value::FLOAT || op == '/') {
-                double lv = (v.type == Value::FLOAT) ? v.f : (double)v.i;
-                double rv = (r.type == Value::FLOAT) ? r.f : (double)r.i;
-                v = Value::make_float(op == '*' ? lv * rv : lv / rv);
-            }
-            if (pos < src.size() && (std::isdigit((unsigned char)src[pos]) || src[pos] == '+' || src[pos] == '-')) {
-                double num = parseNumber();
-                if (std::floor(num) == num) return Value::make_int((long long)num);
-                return Value::make_float(num);
-            }
-            else {
-                long long lv = v.i; long long rv = r.i;
-                v = Value::make_int(op == '*' ? lv * rv : (rv == 0 ? 0 : lv / rv));
-            }
-            std::string id = parseIdent();
+// Chybny program se do cache neuklada, pri dalsim behu se znovu nahlasi.
+void Interpreter::runCached(std::string_view code, const std::string& cachePath, OutputSink& sink) {
+    using Clock = std::chrono::steady_clock;
+    stats = RunStats();
+    Clock::time_point start = Clock::now();
+    uint64_t hash = sourceHash(code);
+    uint32_t flags = optimize ? 1 : 0;
+    try {
+        Chunk chunk;
+        std::string err;
+        SourceFile cached;
+        stats.cacheHit = cached.open(cachePath, err) && readCzb(cached.text(), hash, flags, chunk);
+        cached.close();
+        if (!stats.cacheHit) {
+            chunk = compileSource(code);
+            // zapis pres docasny soubor, soubezny beh nikdy neuvidi pulku cache
+            // (kdyby se dva procesy potkaly i na docasnem souboru, odhali to kontrolni soucet)
+            std::string tmp = cachePath + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+            std::ofstream(tmp, std::ios::binary | std::ios::trunc) << writeCzb(chunk, hash, flags);
+            std::error_code ec;
+            std::filesystem::rename(tmp, cachePath, ec);
+            if (ec) std::filesystem::remove(tmp, ec);
         }
-        else break;
+        stats.compile = std::chrono::duration<double>(Clock::now() - start).count();
+        runChunk(chunk, sink);
+    }
+    catch (const std::string& e) {
+        stats.failed = true;
+        writeError(sink, e);
     }
-    return v;
+    sink.flush();
 }
 
-// Factor := number | identifier | (expr) | boolean literals
-
-/*
-Value Interpreter::parseFactor() {
-    skipSpaces();
-    if (pos < src.size() && src[pos] == '(') { pos++; Value v = parseExpression(); expect(")"); return v; }
-
-    // number
-    if (pos < src.size() && (std::isdigit((unsigned char)src[pos]) || src[pos] == '+' || src[pos] == '-')) {
-        double num = parseNumber();
-        if (std::floor(num) == num) return Value::make_int((long long)num);
-        return Value::make_float(num);
+void Interpreter::runProfiled(std::string_view code, OutputSink& sink, ProfileReport& report) {
+    report = ProfileReport();
+    stats = RunStats();
+    try {
+        Chunk chunk = compileSource(code);
+        VM vm(sink);
+        vm.setLimits(limits);
+        InstrProfile prof;
+        vm.runProfiled(chunk, prof);
+        reportLimit(vm, stats, sink);
+        report = ProfileReport::build(chunk, prof);
+        stats.execute = report.total;
     }
-
-    // identifier or keyword
-    std::string id = parseIdent();
-    if (id == "pravda") return Value::make_bool(true);
-    if (id == "nepravda") return Value::make_bool(false);
-    // variable lookup
-    if (vars.find(id) != vars.end()) return vars[id];
-    throw std::string("Neznamy identifikator: ") + id;
+    catch (const std::string& e) {
+        stats.failed = true;
+        writeError(sink, e);
+    }
+    sink.flush();
 }
-*/
-Value Interpreter::parseFactor() {
-    skipSpaces();
-    if (pos < src.size() && src[pos] == '(') { pos++; Value v = parseExpression(); expect(")"); return v; }
 
-    // string literal
-    if (pos < src.size() && (src[pos] == '"' || src[pos] == '\'')) {
-        char quote = src[pos++];
-        std::string s;
-        while (pos < src.size() && src[pos] != quote) {
-            if (src[pos] == '\\' && pos + 1 < src.size()) {
-                char next = src[++pos];
-                if (next == 'n') s += '\n';
-                else if (next == 't') s += '\t';
-                else s += next;
-                pos++;
-            }
-            else {
-                s += src[pos++];
-            }
-        }
-        if (pos >= src.size() || src[pos] != quote)
-            throw std::string("Neukonceny retezec");
-        pos++;
-        return Value::make_string(s);
+Interpreter::Incremental Interpreter::runIncremental(std::string_view code, OutputSink& sink, uint32_t firstLine) {
+    using Clock = std::chrono::steady_clock;
+    stats = RunStats();
+    Clock::time_point start = Clock::now();
+    bool taken = false;
+    try {
+        Session next{ session->globals, {}, session->functions, session->library };
+        Chunk chunk = compileIncremental(code, next, firstLine);
+        Clock::time_point compiled = Clock::now();
+        stats.compile = std::chrono::duration<double>(compiled - start).count();
+        // stav se prevezme pred behem, chyba za behu ho uz nevrati
+        taken = true;
+        session->globals = std::move(next.globals);
+        session->functions = std::move(next.functions);
+        session->library = std::move(next.library);
+        VM vm(sink);
+        vm.setJit(jit);
+        vm.setLimits(limits);
+        vm.run(chunk, session->vars);
+        reportLimit(vm, stats, sink);
+        stats.execute = std::chrono::duration<double>(Clock::now() - compiled).count();
     }
-
-    // number
-    if (pos < src.size() && (std::isdigit((unsigned char)src[pos]) || src[pos] == '+' || src[pos] == '-')) {
-        double num = parseNumber();
-        if (std::floor(num) == num) return Value::make_int((long long)num);
-        return Value::make_float(num);
+    catch (const std::string& e) {
+        stats.failed = true;
+        writeError(sink, e);
     }
+    sink.flush();
+    if (!stats.failed) return Incremental::Ok;
+    return taken ? Incremental::RuntimeError : Incremental::CompileError;
+}
 
-    // identifier or keyword
-    std::string id = parseIdent();
-    if (id == "pravda") return Value::make_bool(true);
-    if (id == "nepravda") return Value::make_bool(false);
-    if (vars.find(id) != vars.end()) return vars[id];
-    throw std::string("Neznamy identifikator: ") + id;
+void Interpreter::reset() {
+    session = std::make_unique<Session>();
 }
 
+// vstupy jsou prvni sloty framu, vystupy vsechna jmena nejvyssi urovne
+struct Program::Compiled {
+    Chunk chunk;
+    std::vector<std::pair<std::string, int32_t>> inputs;
+    std::vector<std::pair<std::string, int32_t>> outputs;
+};
 
-// Statements: jednoduch sekvence oddlen rkami/novmi dky/bez nich  budeme akceptovat stednk na konci
-void Interpreter::parseStatements() {
-    while (true) {
-        skipSpaces();
-        if (pos >= src.size()) break;
-        parseStatement();
-    }
+Value Environment::get(const std::string& name) const {
+    auto it = vars.find(name);
+    return it == vars.end() ? Value() : it->second;
 }
 
-void Interpreter::parseStatement() {
-    skipSpaces();
-    if (startsWith("cele_cislo") || startsWith("plout") || startsWith("boolean")) {
-        // deklarace: typ ident [= expr] ;
-        std::string typ = parseIdent();
-        std::string name = parseIdent();
-        skipSpaces();
-        if (consumeIf("=")) {
-            Value val = parseExpression();
-            if (typ == "cele_cislo") {
-                if (val.type == Value::FLOAT) vars[name] = Value::make_int((long long)val.f);
-                else if (val.type == Value::INT) vars[name] = val;
-                else throw std::string("Typova chyba pri prirazeni do cele_cislo");
-            }
-            else if (typ == "plout") {
-                if (val.type == Value::FLOAT) vars[name] = val;
-                else if (val.type == Value::INT) vars[name] = Value::make_float((double)val.i);
-                else throw std::string("Typova chyba pri prirazeni do plout");
-            }
-            else if (typ == "boolean") {
-                if (val.type == Value::BOOL) vars[name] = val;
-                else throw std::string("Typova chyba pri prirazeni do boolean");
-            }
-        }
-        else {
-            // default init
-            if (typ == "cele_cislo") vars[name] = Value::make_int(0);
-            else if (typ == "plout") vars[name] = Value::make_float(0.0);
-            else if (typ == "boolean") vars[name] = Value::make_bool(false);
+Program Interpreter::compile(std::string_view code, const Environment& inputs) {
+    using Clock = std::chrono::steady_clock;
+    stats = RunStats();
+    Clock::time_point start = Clock::now();
+    Program program;
+    auto compiled = std::make_shared<Program::Compiled>();
+    Session next;
+    for (const auto& [name, value] : inputs.vars) {
+        if (value.type == Value::NONE) {
+            program.err = "Vstup bez hodnoty: " + name;
+            stats.failed = true;
+            return program;
         }
-        // optional semicolon
-        consumeIf(";");
-        return;
+        int32_t slot = (int32_t)next.globals.slots.size();
+        next.globals.slots.push_back({ name, value.type });
+        next.globals.names[name] = slot;
+        compiled->inputs.push_back({ name, slot });
     }
-
-    // tiskni expr ;
-    if (startsWith("tiskni")) {
-        parseIdent(); // consume 'tiskni'
-        Value v = parseExpression();
-        output += v.toString();
-        output += "            ";
-            consumeIf(";");
-        return;
+    try {
+        compiled->chunk = compileIncremental(code, next, 1);
     }
-
-    // piazen: ident = expr ;
-    if (std::isalpha((unsigned char)src[pos]) || src[pos] == '_') {
-        std::string id = parseIdent();
-        skipSpaces();
-        if (consumeIf("=")) {
-            Value val = parseExpression();
-            if (vars.find(id) == vars.end()) throw std::string("Promenna neexistuje: ") + id;
-            // jednoduchn petypovn podobn jako pi deklaraci
-            Value& dest = vars[id];
-            if (dest.type == Value::INT) {
-                if (val.type == Value::FLOAT) dest = Value::make_int((long long)val.f);
-                else if (val.type == Value::INT) dest = val;
-                else throw std::string("Typova chyba pri prirazeni");
-            }
-            else if (dest.type == Value::FLOAT) {
-                if (val.type == Value::FLOAT) dest = val;
-                else if (val.type == Value::INT) dest = Value::make_float((double)val.i);
-                else throw std::string("Typova chyba pri prirazeni");
-            }
-            else if (dest.type == Value::BOOL) {
-                if (val.type == Value::BOOL) dest = val; else throw std::string("Typova chyba pri prirazeni boolean");
-            }
-            consumeIf(";");
-            return;
-        }
+    catch (const std::string& e) {
+        program.err = e;
+        stats.failed = true;
+        return program;
     }
+    for (const auto& [name, slot] : next.globals.names) compiled->outputs.push_back({ name, slot });
+    program.compiled = std::move(compiled);
+    stats.compile = std::chrono::duration<double>(Clock::now() - start).count();
+    return program;
+}
 
-    // if (pokud) a while (zatimco) bloky  jednoduch tvar: "pokud ( expr ) { ... } [jinak { ... }]"
-    if (startsWith("pokud")) {
-        consumeIf("pokud"); expect("("); Value cond = parseExpression(); expect(")"); expect("{");
-        // capture block
-        size_t block_start = pos; int nest = 1;
-        while (pos < src.size() && nest>0) {
-            if (src[pos] == '{') { nest++; pos++; }
-            else if (src[pos] == '}') { nest--; if (nest == 0) break; pos++; }
-            else pos++;
-        }
-        size_t block_end = pos; expect("}");
-        std::string then_block = src.substr(block_start, block_end - block_start);
-        std::string else_block;
-        skipSpaces();
-        if (startsWith("jinak")) {
-            consumeIf("jinak"); expect("{"); size_t es = pos; int nest2 = 1;
-            while (pos < src.size() && nest2>0) {
-                if (src[pos] == '{') { nest2++; pos++; }
-                else if (src[pos] == '}') { nest2--; if (nest2 == 0) break; pos++; }
-                else pos++;
-            }
-            size_t ee = pos; expect("}");
-            else_block = src.substr(es, ee - es);
-        }
-        if ((cond.type == Value::INT && cond.i != 0) || (cond.type == Value::FLOAT && cond.f != 0.0) || (cond.type == Value::BOOL && cond.b)) {
-            Interpreter sub;
-            sub.vars = this->vars; // copy variables
-            output += sub.run(then_block);
-            this->vars = sub.vars; // get changes back
-        }
-        else if (!else_block.empty()) {
-            Interpreter sub;
-            sub.vars = this->vars;
-            output += sub.run(else_block);
-            this->vars = sub.vars;
+bool Interpreter::execute(const Program& program, Environment& env) {
+    using Clock = std::chrono::steady_clock;
+    stats = RunStats();
+    Clock::time_point start = Clock::now();
+    CallbackSink sink(env.output ? env.output : [](std::string_view) {});
+    if (!program.ok()) {
+        stats.failed = true;
+        writeError(sink, program.error());
+        sink.flush();
+        return false;
+    }
+    const Program::Compiled& c = *program.compiled;
+    std::vector<Value> vars(c.chunk.slotNames.size());
+    for (const auto& [name, slot] : c.inputs) {
+        auto it = env.vars.find(name);
+        Value::Type want = c.chunk.slotTypes[slot];
+        Value v = it == env.vars.end() ? Value() : it->second;
+        if (v.type == Value::INT && want == Value::FLOAT) v = Value::make_float((double)v.i);
+        if (v.type != want) {
+            stats.failed = true;
+            writeError(sink, (it == env.vars.end() ? "Chybi vstup: " : "Vstup ma jiny typ nez pri prekladu: ") + name);
+            sink.flush();
+            return false;
         }
-        return;
+        vars[slot] = std::move(v);
+    }
+    VM vm(sink);
+    vm.setJit(jit);
+    vm.setLimits(limits);
+    try {
+        vm.run(c.chunk, vars);
     }
+    catch (const std::string& e) {
+        stats.failed = true;
+        writeError(sink, e);
+    }
+    reportLimit(vm, stats, sink);
+    for (const auto& [name, slot] : c.outputs) env.vars[name] = vars[slot];
+    sink.flush();
+    stats.execute = std::chrono::duration<double>(Clock::now() - start).count();
+    return !stats.failed;
+}
 
-    if (startsWith("zatimco")) {
-        consumeIf("zatimco"); expect("("); // jednoduch zatimco (condition) {block}
-        size_t cond_start = pos; // parse condition as expression until )
-        // naive: find )
-        int p = 0; while (pos < src.size()) { if (src[pos] == ')') break; pos++; }
-        std::string cond_expr = src.substr(cond_start, pos - cond_start);
-        expect(")"); expect("{"); size_t block_start = pos; int nest = 1;
-        while (pos < src.size() && nest>0) {
-            if (src[pos] == '{') { nest++; pos++; }
-            else if (src[pos] == '}') { nest--; if (nest == 0) break; pos++; }
-            else pos++;
-        }
-        size_t block_end = pos; expect("}");
-        std::string block = src.substr(block_start, block_end - block_start);
-        // loop: evaluate cond by running a small interpreter on cond_expr that returns expression value
-        while (true) {
-            Interpreter condInterp; condInterp.vars = this->vars;
-            // build a tiny program: an expression as a return of "t" - but our interpreter can't return expressions directly
-            // so we embed: cele_cislo __cond = ( ... );
-            std::string prog = std::string("cele_cislo __tmp = ") + cond_expr + ";";
-            condInterp.run(prog);
-            if (condInterp.vars.find("__tmp") == condInterp.vars.end()) break;
-            Value cv = condInterp.vars["__tmp"];
-            bool truth = (cv.type == Value::INT && cv.i != 0) || (cv.type == Value::FLOAT && cv.f != 0.0);
-            if (!truth) break;
-            Interpreter sub; sub.vars = this->vars;
-            output += sub.run(block);
-            this->vars = sub.vars;
+std::string Interpreter::dumpBytecode(std::string_view code, bool incremental, uint32_t firstLine) {
+    try {
+        if (incremental) {
+            Session next{ session->globals, {}, session->functions, session->library };
+            return disassemble(compileIncremental(code, next, firstLine));
         }
-        return;
+        return disassemble(compileSource(code));
+    }
+    catch (const std::string& e) {
+        return std::string("Chyba: ") + e + "\n";
     }
+}
 
-    // otherwise try to skip a token to avoid infinite loop
-    // try semicolon
-    if (consumeIf(";")) return;
-    // unknown token
-    throw std::string("Neznamy statement pri pozici: ") + std::to_string(pos);
+bool Interpreter::transpile(std::string_view code, std::string& cpp, std::string& err) {
+    try {
+        ArenaScope scope(arena);
+        std::vector<Token> toks = tokenize(code);
+        Block program = Parser(toks, arena).parseProgram();
+        std::vector<SlotInfo> slots = Resolver().resolve(program);
+        TypeChecker().check(program, slots);
+        if (optimize) Optimizer(arena).optimize(program, slots);
+        cpp = Transpiler().transpile(program, slots);
+        return true;
+    }
+    catch (const std::string& e) {
+        err = e;
+        return false;
+    }
 }
@@ -1,66 +1,119 @@
 #pragma once
-#include <sstream>
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
-#include <variant>
-#include <vector>
-#include <unordered_map>
+#include <string_view>
+#include "arena.h"
+#include "runlimits.h"
+#include "output.h"
+#include "value.h"
 
-struct Value {
-    enum Type { INT, FLOAT, BOOL, STRING, NONE } type = NONE;
-    long long i = 0;
-    double f = 0.0;
-    bool b = false;
-    std::string s;
-    static Value make_string(const std::string& str) { Value v; v.type = STRING; v.s = str; return v; }
+struct Chunk;
+struct ProfileReport;
 
-   // std::string s;
+// Promenne, ktere si hostitel vymenuje s programem (embedding API). Pred
+// compile() urcuji jmena a typy vstupu, pred execute() jejich hodnoty; po
+// execute() obsahuji i promenne nejvyssi urovne programu.
+class Environment {
+public:
+    void set(const std::string& name, const Value& value) { vars[name] = value; }
+    // hodnota promenne, NONE pokud neexistuje
+    Value get(const std::string& name) const;
+    // kam jde vystup tiskni (po kusech, jak se plni buffer); bez nej se zahodi
+    void setOutput(std::function<void(std::string_view)> fn) { output = std::move(fn); }
+
+private:
+    friend class Interpreter;
+    std::map<std::string, Value> vars; // serazene, vstupy dostanou sloty v pevnem poradi
+    std::function<void(std::string_view)> output;
+};
 
-   // static Value make_string(const std::string& str) { Value v; v.type = STRING; v.s = str; return v; }
+// Prelozeny program pro opakovane Interpreter::execute(). Kopie jsou levne
+// a sdili jeden prelozeny kod. Retezcove konstanty maji nesynchronizovane
+// pocitadlo referenci, jeden Program proto nespoustet z vice vlaken soucasne.
+class Program {
+public:
+    bool ok() const { return compiled != nullptr; }
+    // chybova hlaska prekladu, kdyz !ok()
+    const std::string& error() const { return err; }
 
-    Value parseIdent();
-    Value() = default;
-    static Value make_int(long long x) { Value v; v.type = INT; v.i = x; return v; }
-    static Value make_float(double x) { Value v; v.type = FLOAT; v.f = x; return v; }
-    static Value make_bool(bool x) { Value v; v.type = BOOL; v.b = x; return v; }
-    std::string toString() const {
-        switch (type) {
-        case INT: return std::to_string(i);
-        case FLOAT: { std::ostringstream ss; ss << f; return ss.str(); }
-        case BOOL: return b ? "pravda" : "nepravda";
-        case STRING: return s;
-        default: return "none";
-        }
-    }
+private:
+    friend class Interpreter;
+    struct Compiled;
+    std::shared_ptr<const Compiled> compiled;
+    std::string err;
 };
 
+// Interpret nema zadny sdileny menitelny stav: jednu instanci pouziva
+// vzdy jen jedno vlakno, ruzne instance mohou bezet soucasne (czpp batch).
 class Interpreter {
 public:
     Interpreter();
-    std::string run(const std::string& code);
+    ~Interpreter();
+    std::string run(std::string_view code);
+    // vystup tiskni se prubezne posila do sink, na konci behu se vyprazdni
+    void run(std::string_view code, OutputSink& sink);
+    // jako run(), ale s merenim po radcich a instrukcich (bez JIT, pomalejsi);
+    // pri chybe prekladu zustane report prazdny
+    void runProfiled(std::string_view code, OutputSink& sink, ProfileReport& report);
+    // Jako run(), ale prelozeny program se uklada do cachePath (.czb). Kdyz
+    // cache odpovida zdrojaku a nastaveni, preklad se preskoci a beh zacne
+    // rovnou z namapovaneho souboru; jinak se cache prelozi znovu a prepise.
+    void runCached(std::string_view code, const std::string& cachePath, OutputSink& sink);
+    // Inkrementalni beh (REPL): code navazuje na predchozi volani, promenne
+    // nejvyssi urovne i s hodnotami zustavaji a prelozi se a spusti jen novy
+    // kod. firstLine je cislo jeho prvniho radku pro chybove hlasky. Pri
+    // chybe prekladu se stav nezmeni. Chyba za behu (i limit) prijde az po
+    // prevzeti novych funkci a promennych, ty ve stavu zustanou.
+    enum class Incremental { Ok, CompileError, RuntimeError };
+    Incremental runIncremental(std::string_view code, OutputSink& sink, uint32_t firstLine = 1);
+    // zahodi stav inkrementalniho behu
+    void reset();
 
-private:
-    std::string src;
-    size_t pos = 0;
-    std::string output;
+    // Embedding API: program se prelozi jednou a pak se spousti opakovane
+    // bez prace s textem. Promenne z inputs (jmena a typy hodnot) vidi jako
+    // uz deklarovane. Pri chybe prekladu vrati Program s !ok().
+    Program compile(std::string_view code, const Environment& inputs = Environment());
+    // Spusti program nad env. Vstupy musi v env byt se stejnym typem jako pri
+    // compile() (cele_cislo lze dat i za plout); po behu jsou v env vsechny
+    // promenne nejvyssi urovne. Pri chybe vrati false a hlaska jde do vystupu.
+    bool execute(const Program& program, Environment& env);
+    // vypis prelozeneho bytecode (pro --dump-bytecode); incremental prelozi
+    // code jako pokracovani inkrementalniho behu, stav ale nemeni
+    std::string dumpBytecode(std::string_view code, bool incremental = false, uint32_t firstLine = 1);
+    // preklad programu do samostatneho C++ (czpp compile), viz transpile.h;
+    // pri chybe prekladu vrati false a hlasku v err
+    bool transpile(std::string_view code, std::string& cpp, std::string& err);
 
-    // symbol table
-    std::unordered_map<std::string, Value> vars;
+    // optimalizacni pruchod nad AST (vychozi zapnuto)
+    void setOptimize(bool on) { optimize = on; }
+    // preklad horkych smycek do nativniho kodu (vychozi zapnuto, kde je k dispozici)
+    void setJit(bool on) { jit = on; }
+    // limity kazdeho dalsiho behu (run, runCached, runIncremental, execute, ...);
+    // prekroceni ukonci beh jako chyba a duvod je v lastStats().limit
+    void setLimits(const RunLimits& l) { limits = l; }
 
-    // Lexer/parser helpers
-    void skipSpaces();
-    bool startsWith(const std::string& s);
-    std::string parseIdent();
-    double parseNumber();
-    // Expressions
-    Value parseExpression();
-    Value parseTerm();
-    Value parseFactor();
+    // posledni run(): doba prekladu (lexer az compiler) a behu VM v sekundach
+    struct RunStats {
+        double compile = 0;
+        double execute = 0;
+        bool failed = false; // skoncil chybou
+        bool cacheHit = false; // runCached: program byl nacten z .czb
+        LimitHit limit = LimitHit::None; // beh zastavil limit ze setLimits (pak je i failed)
+    };
+    const RunStats& lastStats() const { return stats; }
 
-    // Statements
-    void parseStatements();
-    void parseStatement();
+private:
+    bool optimize = true;
+    bool jit = true;
+    RunLimits limits;
+    RunStats stats;
+    struct Session;
+    std::unique_ptr<Session> session;
+    Arena arena; // AST jednoho prekladu, po prekladu se vyprazdni
 
-    // utilities
-    bool consumeIf(const std::string& s);
-    void expect(const std::string& s);
+    Chunk compileSource(std::string_view code);
+    void runChunk(const Chunk& chunk, OutputSink& sink);
+    Chunk compileIncremental(std::string_view code, Session& next, uint32_t firstLine);
 };
\ No newline at end of file
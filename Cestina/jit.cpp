@@ -0,0 +1,451 @@
+#include "jit.h"
+#include "arith.h"
+#include <cstddef>
+#include <cstring>
+
+#if CZPP_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+int32_t Jit::enter(const JitLoop& loop, Value* frame) {
+    for (const auto& g : loop.guards)
+        if (frame[g.first].type != g.second) return -1;
+    return loop.fn(frame);
+}
+
+#if !CZPP_JIT
+
+Jit::~Jit() {}
+
+const JitLoop* Jit::compile(const Chunk&, int32_t, int32_t, int64_t*) { return nullptr; }
+
+#else
+
+Jit::~Jit() {
+    for (auto& l : loops) munmap(l->mem, l->size);
+}
+
+namespace {
+
+// Registry x86-64 a podminky skoku/setcc.
+enum Reg : uint8_t { RAX = 0, RCX = 1, RDX = 2, RSI = 6, RDI = 7, R8 = 8, R9 = 9, R10 = 10, R11 = 11 };
+enum Cond : uint8_t { CC_B = 2, CC_AE = 3, CC_E = 4, CC_NE = 5, CC_A = 7, CC_P = 10, CC_NP = 11, CC_L = 12, CC_GE = 13, CC_LE = 14, CC_G = 15 };
+
+// Zasobnik VM v registrech: hloubka d je v GPR[d] nebo XMM[d] podle typu.
+// RAX a RDX jsou pomocne (idiv), RDI drzi frame, XMM7 je pomocny.
+const Reg GPR[] = { RCX, RSI, R8, R9, R10, R11 };
+const int MAX_DEPTH = 6;
+const int XMM_TMP = 7;
+
+// Jen instrukce, ktere JIT potrebuje. Pamet je vzdy [rdi + disp32].
+struct Asm {
+    std::vector<uint8_t> buf;
+
+    int32_t size() const { return (int32_t)buf.size(); }
+    void byte(uint8_t b) { buf.push_back(b); }
+    void dword(int32_t v) { uint8_t b[4]; std::memcpy(b, &v, 4); buf.insert(buf.end(), b, b + 4); }
+    void qword(int64_t v) { uint8_t b[8]; std::memcpy(b, &v, 8); buf.insert(buf.end(), b, b + 8); }
+    void patch32(int32_t at, int32_t v) { std::memcpy(&buf[at], &v, 4); }
+
+    void rex(bool w, int reg, int rm, bool force = false) {
+        uint8_t r = 0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+        if (r != 0x40 || force) byte(r);
+    }
+    void modrmReg(int reg, int rm) { byte(0xC0 | ((reg & 7) << 3) | (rm & 7)); }
+    void modrmMem(int reg, int32_t disp) { byte(0x80 | ((reg & 7) << 3) | RDI); dword(disp); }
+
+    void load(Reg r, int32_t disp) { rex(true, r, RDI); byte(0x8B); modrmMem(r, disp); }
+    void store(int32_t disp, Reg r) { rex(true, r, RDI); byte(0x89); modrmMem(r, disp); }
+    void loadByte(Reg r, int32_t disp) { rex(false, r, RDI); byte(0x0F); byte(0xB6); modrmMem(r, disp); }
+    void storeTag(int32_t disp, uint8_t v) { byte(0xC6); modrmMem(0, disp); byte(v); }
+    void cmpMem(Reg r, int32_t disp) { rex(true, r, RDI); byte(0x3B); modrmMem(r, disp); }
+    void movImm(Reg r, int64_t v) { rex(true, 0, r); byte(0xB8 + (r & 7)); qword(v); }
+    void mov(Reg dst, Reg src) { rex(true, src, dst); byte(0x89); modrmReg(src, dst); }
+    // add/sub/cmp/xor/test dst, src
+    void alu(uint8_t op, Reg dst, Reg src) { rex(true, src, dst); byte(op); modrmReg(src, dst); }
+    void imul(Reg dst, Reg src) { rex(true, dst, src); byte(0x0F); byte(0xAF); modrmReg(dst, src); }
+    void aluImm(uint8_t ext, Reg r, int32_t v) { rex(true, 0, r); byte(0x81); modrmReg(ext, r); dword(v); }
+    void subMemImm(Reg base, int32_t v) { rex(true, 0, base); byte(0x81); byte((5 << 3) | (base & 7)); dword(v); } // sub qword [base], v
+    void neg(Reg r) { rex(true, 0, r); byte(0xF7); modrmReg(3, r); }
+    void cqo() { byte(0x48); byte(0x99); }
+    void idiv(Reg r) { rex(true, 0, r); byte(0xF7); modrmReg(7, r); }
+    void setcc(Cond c, Reg r8) { rex(false, 0, r8, r8 >= 4); byte(0x0F); byte(0x90 + c); modrmReg(0, r8); }
+    void movzxByte(Reg dst, Reg src8) { rex(false, dst, src8, src8 >= 4); byte(0x0F); byte(0xB6); modrmReg(dst, src8); }
+
+    void loadSd(int x, int32_t disp) { byte(0xF2); rex(false, x, RDI); byte(0x0F); byte(0x10); modrmMem(x, disp); }
+    void storeSd(int32_t disp, int x) { byte(0xF2); rex(false, x, RDI); byte(0x0F); byte(0x11); modrmMem(x, disp); }
+    // addsd 58, mulsd 59, subsd 5C, divsd 5E
+    void sse(uint8_t op, int dst, int src) { byte(0xF2); rex(false, dst, src); byte(0x0F); byte(op); modrmReg(dst, src); }
+    void movqToXmm(int x, Reg r) { byte(0x66); rex(true, x, r); byte(0x0F); byte(0x6E); modrmReg(x, r); }
+    void cvtsi2sd(int x, Reg r) { byte(0xF2); rex(true, x, r); byte(0x0F); byte(0x2A); modrmReg(x, r); }
+    void cvttsd2si(Reg r, int x) { byte(0xF2); rex(true, r, x); byte(0x0F); byte(0x2C); modrmReg(r, x); }
+    void ucomisd(int a, int b) { byte(0x66); rex(false, a, b); byte(0x0F); byte(0x2E); modrmReg(a, b); }
+    void xorpd(int x) { byte(0x66); rex(false, x, x); byte(0x0F); byte(0x57); modrmReg(x, x); }
+
+    // skoky s rel32, vraci pozici operandu pro pozdejsi doplneni
+    int32_t jcc(Cond c) { byte(0x0F); byte(0x80 + c); dword(0); return size() - 4; }
+    int32_t jmp() { byte(0xE9); dword(0); return size() - 4; }
+    void bind(int32_t at, int32_t target) { patch32(at, target - (at + 4)); }
+    void retIndex(int32_t k) { byte(0xB8); dword(k); byte(0xC3); } // mov eax, k; ret
+};
+
+int32_t tagOf(int32_t slot) { return slot * (int32_t)sizeof(Value) + (int32_t)offsetof(Value, type); }
+int32_t dataOf(int32_t slot) { return slot * (int32_t)sizeof(Value) + (int32_t)offsetof(Value, i); }
+
+struct LoopCompiler {
+    const Chunk& chunk;
+    int32_t head, end;
+    Asm a;
+    std::vector<Value::Type> stack;  // typy na zasobniku VM v prave prekladane instrukci
+    std::vector<int32_t> native;     // bytecode index - head -> offset v kodu
+    std::vector<bool> target;        // na instrukci se skace
+    std::vector<bool> declared;      // slot ma ve smycce DECL_SLOT
+    std::vector<std::pair<int32_t, int32_t>> fixups; // (operand skoku, cilova instrukce)
+    struct BackJump { int32_t at, from, to; };       // operand skoku, zdrojova a cilova instrukce
+    std::vector<BackJump> backs;                      // zpetne skoky, kdyz se kontroluji limity
+    int64_t* budget;
+    const FuncInfo* fn; // smycka v tele funkce: jeji sloty (bez konstant), jinak frame programu
+    int32_t cur = 0; // prave prekladana instrukce
+    JitLoop& out;
+
+    LoopCompiler(const Chunk& chunk, int32_t head, int32_t end, int64_t* budget, const FuncInfo* fn, JitLoop& out)
+        : chunk(chunk), head(head), end(end), budget(budget), fn(fn), out(out) {}
+
+    size_t vars() const { return fn ? fn->slotTypes.size() : chunk.slotNames.size(); }
+
+    Value::Type slotType(int32_t slot) const {
+        if ((size_t)slot < vars()) return fn ? fn->slotTypes[slot] : chunk.slotTypes[slot];
+        return chunk.constants[slot - vars()].type;
+    }
+
+    // slot zvenku smycky: typ se hlida pri vstupu
+    void guard(int32_t slot, Value::Type t) {
+        if ((size_t)slot >= vars() || declared[slot]) return;
+        for (const auto& g : out.guards) if (g.first == slot) return;
+        out.guards.push_back({ slot, t });
+    }
+
+    bool push(Value::Type t) {
+        if ((int)stack.size() >= MAX_DEPTH) return false;
+        stack.push_back(t);
+        return true;
+    }
+
+    void jumpTo(int32_t at, int32_t k) {
+        if (budget && k <= cur && k >= head) backs.push_back({ at, cur, k });
+        else fixups.push_back({ at, k });
+    }
+
+    // skok podle pravdivosti hodnoty na vrcholu (ta se odebere)
+    bool branch(bool ifTrue, int32_t k) {
+        int d = (int)stack.size() - 1;
+        Value::Type t = stack[d];
+        stack.pop_back();
+        if (!stack.empty()) return false;
+        if (t == Value::FLOAT) {
+            // NaN je pravdive, nepravdive je jen 0.0 (ZF=1 a PF=0)
+            a.xorpd(XMM_TMP);
+            a.ucomisd(d, XMM_TMP);
+            if (ifTrue) {
+                jumpTo(a.jcc(CC_P), k);
+                jumpTo(a.jcc(CC_NE), k);
+            }
+            else {
+                int32_t skip = a.jcc(CC_P);
+                jumpTo(a.jcc(CC_E), k);
+                a.bind(skip, a.size());
+            }
+            return true;
+        }
+        if (t != Value::INT && t != Value::BOOL) return false;
+        a.alu(0x85, GPR[d], GPR[d]);
+        jumpTo(a.jcc(ifTrue ? CC_NE : CC_E), k);
+        return true;
+    }
+
+    // ADD_INT .. DIV_FLOAT, oba operandy uz maji typ t
+    bool arith(BinOp op, Value::Type t) {
+        int d = (int)stack.size() - 2;
+        if (stack[d] != t || stack[d + 1] != t) return false;
+        stack.pop_back();
+        if (t == Value::FLOAT) {
+            uint8_t code = op == BinOp::Add ? 0x58 : op == BinOp::Sub ? 0x5C : op == BinOp::Mul ? 0x59 : 0x5E;
+            a.sse(code, d, d + 1);
+            return true;
+        }
+        Reg x = GPR[d], y = GPR[d + 1];
+        switch (op) {
+        case BinOp::Add: a.alu(0x01, x, y); break;
+        case BinOp::Sub: a.alu(0x29, x, y); break;
+        case BinOp::Mul: a.imul(x, y); break;
+        default: {
+            // intDiv: deleni nulou dava 0, deleni -1 je negace (bez preteceni idiv)
+            a.alu(0x85, y, y);
+            int32_t zero = a.jcc(CC_E);
+            a.aluImm(7, y, -1);
+            int32_t minus = a.jcc(CC_E);
+            a.mov(RAX, x);
+            a.cqo();
+            a.idiv(y);
+            a.mov(x, RAX);
+            int32_t done1 = a.jmp();
+            a.bind(zero, a.size());
+            a.alu(0x31, x, x);
+            int32_t done2 = a.jmp();
+            a.bind(minus, a.size());
+            a.neg(x);
+            a.bind(done1, a.size());
+            a.bind(done2, a.size());
+            break;
+        }
+        }
+        return true;
+    }
+
+    // LT_INT .. NE_BOOL, vysledek je boolean; retezce JIT neumi
+    bool compare(BinOp op, Value::Type t) {
+        int d = (int)stack.size() - 2;
+        if (stack[d] != t || stack[d + 1] != t || t == Value::STRING) return false;
+        stack.pop_back();
+        stack[d] = Value::BOOL;
+        if (t != Value::FLOAT) {
+            a.alu(0x39, GPR[d], GPR[d + 1]);
+            Cond c = op == BinOp::Lt ? CC_L : op == BinOp::Le ? CC_LE : op == BinOp::Gt ? CC_G
+                : op == BinOp::Ge ? CC_GE : op == BinOp::Eq ? CC_E : CC_NE;
+            a.setcc(c, RAX);
+            a.movzxByte(GPR[d], RAX);
+            return true;
+        }
+        // ucomisd nastavi CF/ZF jako porovnani bez znamenka, NaN nastavi i PF
+        switch (op) {
+        case BinOp::Lt: a.ucomisd(d + 1, d); a.setcc(CC_A, RAX); break;
+        case BinOp::Le: a.ucomisd(d + 1, d); a.setcc(CC_AE, RAX); break;
+        case BinOp::Gt: a.ucomisd(d, d + 1); a.setcc(CC_A, RAX); break;
+        case BinOp::Ge: a.ucomisd(d, d + 1); a.setcc(CC_AE, RAX); break;
+        case BinOp::Eq:
+            a.ucomisd(d, d + 1);
+            a.setcc(CC_E, RAX);
+            a.setcc(CC_NP, RDX);
+            a.byte(0x20); a.modrmReg(RDX, RAX); // and al, dl
+            break;
+        default:
+            a.ucomisd(d, d + 1);
+            a.setcc(CC_NE, RAX);
+            a.setcc(CC_P, RDX);
+            a.byte(0x08); a.modrmReg(RDX, RAX); // or al, dl
+            break;
+        }
+        a.movzxByte(GPR[d], RAX);
+        return true;
+    }
+
+    // DECL_SLOT / STORE_SLOT: prevody uz udelaly I2F/F2I
+    bool store(int32_t slot, int32_t type) {
+        int d = (int)stack.size() - 1;
+        Value::Type t = stack[d];
+        stack.pop_back();
+        if (t != type) return false;
+        if (t == Value::FLOAT) a.storeSd(dataOf(slot), d);
+        else if (t == Value::INT || t == Value::BOOL) a.store(dataOf(slot), GPR[d]);
+        else return false;
+        a.storeTag(tagOf(slot), (uint8_t)type);
+        if (!declared[slot]) guard(slot, (Value::Type)type);
+        return true;
+    }
+
+    bool instr(int32_t k) {
+        const Instr& in = chunk.code[k];
+        switch (in.op) {
+        case Op::PUSH_CONST: {
+            const Value& c = chunk.constants[in.a];
+            int d = (int)stack.size();
+            if (!push(c.type)) return false;
+            if (c.type == Value::INT) a.movImm(GPR[d], c.i);
+            else if (c.type == Value::BOOL) a.movImm(GPR[d], c.b ? 1 : 0);
+            else if (c.type == Value::FLOAT) {
+                int64_t bits;
+                std::memcpy(&bits, &c.f, sizeof bits);
+                a.movImm(RAX, bits);
+                a.movqToXmm(d, RAX);
+            }
+            else return false;
+            return true;
+        }
+        case Op::LOAD_SLOT: {
+            Value::Type t = slotType(in.a);
+            int d = (int)stack.size();
+            if (!push(t)) return false;
+            if (t == Value::INT) a.load(GPR[d], dataOf(in.a));
+            else if (t == Value::BOOL) a.loadByte(GPR[d], dataOf(in.a));
+            else if (t == Value::FLOAT) a.loadSd(d, dataOf(in.a));
+            else return false;
+            guard(in.a, t);
+            return true;
+        }
+        case Op::DECL_SLOT:
+        case Op::STORE_SLOT:
+            return store(in.a, in.b);
+        case Op::ADD_INT: return arith(BinOp::Add, Value::INT);
+        case Op::SUB_INT: return arith(BinOp::Sub, Value::INT);
+        case Op::MUL_INT: return arith(BinOp::Mul, Value::INT);
+        case Op::DIV_INT: return arith(BinOp::Div, Value::INT);
+        case Op::ADD_FLOAT: return arith(BinOp::Add, Value::FLOAT);
+        case Op::SUB_FLOAT: return arith(BinOp::Sub, Value::FLOAT);
+        case Op::MUL_FLOAT: return arith(BinOp::Mul, Value::FLOAT);
+        case Op::DIV_FLOAT: return arith(BinOp::Div, Value::FLOAT);
+        case Op::LT_INT: return compare(BinOp::Lt, Value::INT);
+        case Op::LE_INT: return compare(BinOp::Le, Value::INT);
+        case Op::GT_INT: return compare(BinOp::Gt, Value::INT);
+        case Op::GE_INT: return compare(BinOp::Ge, Value::INT);
+        case Op::EQ_INT: return compare(BinOp::Eq, Value::INT);
+        case Op::NE_INT: return compare(BinOp::Ne, Value::INT);
+        case Op::LT_FLOAT: return compare(BinOp::Lt, Value::FLOAT);
+        case Op::LE_FLOAT: return compare(BinOp::Le, Value::FLOAT);
+        case Op::GT_FLOAT: return compare(BinOp::Gt, Value::FLOAT);
+        case Op::GE_FLOAT: return compare(BinOp::Ge, Value::FLOAT);
+        case Op::EQ_FLOAT: return compare(BinOp::Eq, Value::FLOAT);
+        case Op::NE_FLOAT: return compare(BinOp::Ne, Value::FLOAT);
+        case Op::EQ_BOOL: return compare(BinOp::Eq, Value::BOOL);
+        case Op::NE_BOOL: return compare(BinOp::Ne, Value::BOOL);
+        case Op::I2F: {
+            int d = (int)stack.size() - 1;
+            if (stack[d] != Value::INT) return false;
+            a.cvtsi2sd(d, GPR[d]);
+            stack[d] = Value::FLOAT;
+            return true;
+        }
+        case Op::F2I: {
+            int d = (int)stack.size() - 1;
+            if (stack[d] != Value::FLOAT) return false;
+            a.cvttsd2si(GPR[d], d);
+            stack[d] = Value::INT;
+            return true;
+        }
+        case Op::JUMP:
+            if (!stack.empty()) return false;
+            jumpTo(a.jmp(), in.a);
+            return true;
+        case Op::JUMP_IF_FALSE:
+            return branch(false, in.a);
+        case Op::JUMP_IF_TRUE:
+            return branch(true, in.a);
+        case Op::FOR_LT:
+        case Op::FOR_LE:
+        case Op::FOR_GT:
+        case Op::FOR_GE:
+        case Op::FOR_NE: {
+            if (!stack.empty() || k + 1 >= end || slotType(in.a) != Value::INT || slotType(in.b) != Value::INT) return false;
+            guard(in.a, Value::INT);
+            guard(in.b, Value::INT);
+            a.load(RAX, dataOf(in.a));
+            a.aluImm(0, RAX, chunk.code[k + 1].a);
+            a.store(dataOf(in.a), RAX);
+            a.cmpMem(RAX, dataOf(in.b));
+            Cond c = in.op == Op::FOR_LT ? CC_L : in.op == Op::FOR_LE ? CC_LE : in.op == Op::FOR_GT ? CC_G
+                : in.op == Op::FOR_GE ? CC_GE : CC_NE;
+            jumpTo(a.jcc(c), in.c);
+            return true;
+        }
+        case Op::EXTRA_ARG:
+            return true;
+        default:
+            return false; // PRINT, HALT, volani funkci, porovnani retezcu
+        }
+    }
+
+    bool run() {
+        size_t n = (size_t)(end - head);
+        native.assign(n, 0);
+        target.assign(n, false);
+        declared.assign(vars(), false);
+        for (int32_t k = head; k < end; k++) {
+            const Instr& in = chunk.code[k];
+            switch (in.op) {
+            case Op::JUMP:
+            case Op::JUMP_IF_FALSE:
+            case Op::JUMP_IF_TRUE:
+                if (in.a >= head && in.a < end) target[in.a - head] = true;
+                break;
+            case Op::DECL_SLOT:
+                declared[in.a] = true;
+                break;
+            default:
+                break;
+            }
+        }
+        for (int32_t k = head; k < end; k++) {
+            // na cile skoku je zasobnik VM vzdy prazdny (hranice prikazu)
+            if (target[k - head] && !stack.empty()) return false;
+            native[k - head] = a.size();
+            cur = k;
+            if (!instr(k)) return false;
+            if (chunk.code[k].op == Op::JUMP) stack.clear();
+        }
+        if (!stack.empty()) return false;
+        a.retIndex(end);
+
+        // zpetny skok odecte delku tela od budget; kdyz dojde, VM pokracuje
+        // na cili skoku (zasobnik je tam prazdny) a zkontroluje limity
+        for (const BackJump& b : backs) {
+            a.bind(b.at, a.size());
+            a.movImm(RAX, (int64_t)(intptr_t)budget);
+            a.subMemImm(RAX, b.from - b.to + 1);
+            int32_t stop = a.jcc(CC_LE);
+            a.bind(a.jmp(), native[b.to - head]);
+            a.bind(stop, a.size());
+            a.retIndex(b.to);
+        }
+
+        // skoky ven ze smycky vraci index, kde ma pokracovat VM
+        std::vector<std::pair<int32_t, int32_t>> exits;
+        for (const auto& f : fixups) {
+            int32_t k = f.second;
+            if (k >= head && k < end) {
+                a.bind(f.first, native[k - head]);
+                continue;
+            }
+            int32_t stub = -1;
+            for (const auto& e : exits) if (e.first == k) stub = e.second;
+            if (stub < 0) {
+                stub = a.size();
+                a.retIndex(k);
+                exits.push_back({ k, stub });
+            }
+            a.bind(f.first, stub);
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+const JitLoop* Jit::compile(const Chunk& chunk, int32_t head, int32_t back, int64_t* budget) {
+    auto loop = std::make_unique<JitLoop>();
+    // FOR_* nese krok v nasledujicim EXTRA_ARG, patri ke smycce
+    int32_t end = back + 1;
+    if (end < (int32_t)chunk.code.size() && chunk.code[end].op == Op::EXTRA_ARG) end++;
+    const FuncInfo* fn = nullptr;
+    for (const FuncInfo& f : chunk.functions)
+        if (head >= f.entry && head < f.end) fn = &f;
+    LoopCompiler lc(chunk, head, end, budget, fn, *loop);
+    if (!lc.run()) return nullptr;
+
+    // kod se zapise do RW stranek a pak se prepnou na RX (nikdy oboji naraz)
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = (lc.a.buf.size() + page - 1) / page * page;
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return nullptr;
+    std::memcpy(mem, lc.a.buf.data(), lc.a.buf.size());
+    if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, size);
+        return nullptr;
+    }
+    loop->mem = mem;
+    loop->size = size;
+    loop->fn = reinterpret_cast<JitLoop::Fn>(mem);
+    loops.push_back(std::move(loop));
+    return loops.back().get();
+}
+
+#endif
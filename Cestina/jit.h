@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "bytecode.h"
+
+// Nativni preklad horkych smycek. Zatim jen Linux na x86-64, jinde se
+// smycky vzdy interpretuji.
+#ifndef CZPP_JIT
+#if defined(__x86_64__) && defined(__linux__)
+#define CZPP_JIT 1
+#else
+#define CZPP_JIT 0
+#endif
+#endif
+
+// Po kolika zpetnych skocich se smycka zkusi prelozit.
+#ifndef CZPP_JIT_THRESHOLD
+#define CZPP_JIT_THRESHOLD 1000
+#endif
+
+// Prelozena smycka. Kod dostane frame VM a vrati index instrukce, kterou
+// ma VM pokracovat (prvni za smyckou).
+struct JitLoop {
+    using Fn = int32_t (*)(Value* frame);
+    Fn fn = nullptr;
+    void* mem = nullptr;
+    size_t size = 0;
+    // sloty ctene ve smycce, ktere v ni nejsou deklarovane: typ se overi pri vstupu
+    std::vector<std::pair<int32_t, Value::Type>> guards;
+};
+
+// Sablonovy JIT nad bytecode jedne smycky. Hodnoty zasobniku VM drzi v
+// registrech (cele_cislo a boolean v obecnych, plout v XMM), promenne cte
+// a zapisuje primo ve framu. Instrukce uz jsou typove specializovane
+// (TypeChecker), takze typ kazde hodnoty je znamy pri prekladu. Smycku
+// s cimkoli, co neumi (tiskni, retezce), odmitne a VM ji dal interpretuje.
+class Jit {
+public:
+    Jit() = default;
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+    ~Jit();
+
+    static bool available() { return CZPP_JIT != 0; }
+
+    // smycka [head, back], back je jeji zpetny skok; nullptr = neprelozitelna.
+    // S budget odecita kazdy zpetny skok delku tela a pri budget <= 0 se
+    // vrati do VM na cil skoku (kontrola limitu, viz VM::checkLimits).
+    const JitLoop* compile(const Chunk& chunk, int32_t head, int32_t back, int64_t* budget = nullptr);
+    // -1, pokud typy ve framu neodpovidaji prekladu (VM pak pokracuje sama)
+    static int32_t enter(const JitLoop& loop, Value* frame);
+
+private:
+    std::vector<std::unique_ptr<JitLoop>> loops;
+};
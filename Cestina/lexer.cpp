@@ -0,0 +1,201 @@
+#include "lexer.h"
+#include <cctype>
+#include <charconv>
+#include <cmath>
+
+static bool isIdentStart(char c) { return std::isalpha((unsigned char)c) || c == '_'; }
+static bool isIdentChar(char c) { return std::isalnum((unsigned char)c) || c == '_'; }
+
+static Tok keyword(std::string_view w) {
+    switch (w.size()) {
+    case 4:
+        if (w == "pole") return Tok::Pole;
+        if (w == "vrat") return Tok::Vrat;
+        break;
+    case 5:
+        if (w == "plout") return Tok::Plout;
+        if (w == "pokud") return Tok::Pokud;
+        if (w == "jinak") return Tok::Jinak;
+        break;
+    case 6:
+        if (w == "tiskni") return Tok::Tiskni;
+        if (w == "pravda") return Tok::Pravda;
+        if (w == "funkce") return Tok::Funkce;
+        break;
+    case 7:
+        if (w == "boolean") return Tok::Boolean;
+        if (w == "zatimco") return Tok::Zatimco;
+        if (w == "slovnik") return Tok::Slovnik;
+        break;
+    case 8:
+        if (w == "nepravda") return Tok::Nepravda;
+        break;
+    case 10:
+        if (w == "cele_cislo") return Tok::CeleCislo;
+        break;
+    }
+    return Tok::Ident;
+}
+
+std::string tokPos(const Token& t) {
+    return " (radek " + std::to_string(t.line) + ", sloupec " + std::to_string(t.col) + ")";
+}
+
+const char* tokName(Tok kind) {
+    switch (kind) {
+    case Tok::End: return "konec souboru";
+    case Tok::Ident: return "identifikator";
+    case Tok::Number: return "cislo";
+    case Tok::String: return "retezec";
+    case Tok::CeleCislo: return "cele_cislo";
+    case Tok::Plout: return "plout";
+    case Tok::Boolean: return "boolean";
+    case Tok::Pole: return "pole";
+    case Tok::Slovnik: return "slovnik";
+    case Tok::Tiskni: return "tiskni";
+    case Tok::Pokud: return "pokud";
+    case Tok::Jinak: return "jinak";
+    case Tok::Zatimco: return "zatimco";
+    case Tok::Pravda: return "pravda";
+    case Tok::Nepravda: return "nepravda";
+    case Tok::Funkce: return "funkce";
+    case Tok::Vrat: return "vrat";
+    case Tok::Assign: return "=";
+    case Tok::Semicolon: return ";";
+    case Tok::Comma: return ",";
+    case Tok::LParen: return "(";
+    case Tok::RParen: return ")";
+    case Tok::LBrace: return "{";
+    case Tok::RBrace: return "}";
+    case Tok::LBracket: return "[";
+    case Tok::RBracket: return "]";
+    case Tok::Plus: return "+";
+    case Tok::Minus: return "-";
+    case Tok::Star: return "*";
+    case Tok::Slash: return "/";
+    case Tok::Lt: return "<";
+    case Tok::Le: return "<=";
+    case Tok::Gt: return ">";
+    case Tok::Ge: return ">=";
+    case Tok::Eq: return "==";
+    case Tok::Ne: return "!=";
+    }
+    return "?";
+}
+
+std::vector<Token> tokenize(std::string_view src, uint32_t firstLine) {
+    std::vector<Token> out;
+    out.reserve(src.size() / 4 + 1);
+    size_t pos = 0;
+    uint32_t line = firstLine;
+    size_t lineStart = 0;
+    if (src.substr(0, 3) == "\xEF\xBB\xBF") pos = lineStart = 3; // UTF-8 BOM z Notepadu
+
+    auto make = [&](Tok kind, size_t start, size_t len) -> Token& {
+        Token& t = out.emplace_back();
+        t.kind = kind;
+        t.line = line;
+        t.col = (uint32_t)(start - lineStart + 1);
+        t.text = src.substr(start, len);
+        return t;
+    };
+
+    while (pos < src.size()) {
+        char c = src[pos];
+        if (c == '\n') { pos++; line++; lineStart = pos; continue; }
+        if (std::isspace((unsigned char)c)) { pos++; continue; }
+
+        size_t start = pos;
+        if (isIdentStart(c)) {
+            pos++;
+            while (pos < src.size() && isIdentChar(src[pos])) pos++;
+            std::string_view w = src.substr(start, pos - start);
+            make(keyword(w), start, w.size());
+            continue;
+        }
+
+        if (std::isdigit((unsigned char)c)) {
+            bool dot = false;
+            while (pos < src.size() && (std::isdigit((unsigned char)src[pos]) || (!dot && src[pos] == '.'))) {
+                if (src[pos] == '.') dot = true;
+                pos++;
+            }
+            Token& t = make(Tok::Number, start, pos - start);
+            const char* b = src.data() + start;
+            const char* e = src.data() + pos;
+            if (!dot && std::from_chars(b, e, t.i).ec == std::errc()) {
+                t.isInt = true;
+            }
+            else {
+                double num = 0.0;
+                std::from_chars(b, e, num);
+                // cele hodnoty se chovaji jako cele_cislo, stejne jako puvodni parseNumber
+                if (std::floor(num) == num && std::fabs(num) < 9.2e18) { t.isInt = true; t.i = (long long)num; }
+                else t.f = num;
+            }
+            continue;
+        }
+
+        if (c == '"' || c == '\'') {
+            char quote = c;
+            uint32_t startLine = line;
+            uint32_t startCol = (uint32_t)(start - lineStart + 1);
+            pos++;
+            while (pos < src.size() && src[pos] != quote) {
+                if (src[pos] == '\\' && pos + 1 < src.size()) pos++;
+                if (src[pos] == '\n') { line++; lineStart = pos + 1; }
+                pos++;
+            }
+            if (pos >= src.size())
+                throw std::string("Neukonceny retezec (radek ") + std::to_string(startLine) + ", sloupec " + std::to_string(startCol) + ")";
+            Token& t = out.emplace_back();
+            t.kind = Tok::String;
+            t.line = startLine;
+            t.col = startCol;
+            t.text = src.substr(start + 1, pos - start - 1);
+            pos++;
+            continue;
+        }
+
+        // dvojznakove operatory porovnani
+        char next = pos + 1 < src.size() ? src[pos + 1] : '\0';
+        if (next == '=' && (c == '<' || c == '>' || c == '=' || c == '!')) {
+            make(c == '<' ? Tok::Le : c == '>' ? Tok::Ge : c == '=' ? Tok::Eq : Tok::Ne, start, 2);
+            pos += 2;
+            continue;
+        }
+
+        Tok kind;
+        switch (c) {
+        case '=': kind = Tok::Assign; break;
+        case ';': kind = Tok::Semicolon; break;
+        case ',': kind = Tok::Comma; break;
+        case '(': kind = Tok::LParen; break;
+        case ')': kind = Tok::RParen; break;
+        case '{': kind = Tok::LBrace; break;
+        case '}': kind = Tok::RBrace; break;
+        case '[': kind = Tok::LBracket; break;
+        case ']': kind = Tok::RBracket; break;
+        case '+': kind = Tok::Plus; break;
+        case '-': kind = Tok::Minus; break;
+        case '*': kind = Tok::Star; break;
+        case '/': kind = Tok::Slash; break;
+        case '<': kind = Tok::Lt; break;
+        case '>': kind = Tok::Gt; break;
+        default: {
+            Token bad;
+            bad.line = line;
+            bad.col = (uint32_t)(start - lineStart + 1);
+            throw std::string("Neocekavany znak '") + c + "'" + tokPos(bad);
+        }
+        }
+        pos++;
+        make(kind, start, 1);
+    }
+
+    Token& end = out.emplace_back();
+    end.kind = Tok::End;
+    end.line = line;
+    end.col = (uint32_t)(pos - lineStart + 1);
+    return out;
+}
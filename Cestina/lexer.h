@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Druhy tokenu. Klicova slova maji vlastni druh, takze parser porovnava
+// jen cisla a nikdy neporovnava retezce.
+enum class Tok : uint8_t {
+    End, Ident, Number, String,
+    // klicova slova
+    CeleCislo, Plout, Boolean, Pole, Slovnik, Tiskni, Pokud, Jinak, Zatimco, Pravda, Nepravda, Funkce, Vrat,
+    // operatory a oddelovace
+    Assign, Semicolon, Comma, LParen, RParen, LBrace, RBrace, LBracket, RBracket, Plus, Minus, Star, Slash,
+    Lt, Le, Gt, Ge, Eq, Ne,
+};
+
+struct Token {
+    Tok kind = Tok::End;
+    bool isInt = false;      // Number: literal s celociselnou hodnotou (i "2.0", stejne jako drive)
+    uint32_t line = 1;
+    uint32_t col = 1;
+    std::string_view text;   // usek zdrojaku; u retezcu bez uvozovek a bez zpracovani escape sekvenci
+    union {
+        long long i;
+        double f;
+    };
+    Token() : i(0) {}
+};
+
+// Jednopruchodovy lexer. Tokeny ukazuji primo do zdrojaku, ten proto musi
+// zit alespon tak dlouho jako vraceny vektor. firstLine je cislo prvniho
+// radku (inkrementalni REPL preklada jen konec bufferu).
+std::vector<Token> tokenize(std::string_view src, uint32_t firstLine = 1);
+
+const char* tokName(Tok kind);
+std::string tokPos(const Token& t);
@@ -0,0 +1,159 @@
+#include "loops.h"
+#include <climits>
+
+void LoopOptimizer::optimize(Block& program, std::vector<SlotInfo>& slotInfo) {
+    slots = &slotInfo;
+    isTemp.assign(slotInfo.size(), false);
+    temps = 0;
+    visitBlock(program);
+}
+
+// Vytazene deklarace se pridavaji na konec pending pred svou smycku.
+void LoopOptimizer::visitBlock(Block& block) {
+    size_t start = pending.size();
+    for (StmtPtr s : block.stmts) {
+        if (s->kind == Stmt::If) {
+            visitBlock(s->body);
+            visitBlock(s->elseBody);
+        }
+        else if (s->kind == Stmt::While) {
+            visitBlock(s->body);
+            hoistLoop(*s);
+            detectCounted(*s);
+        }
+        pending.push_back(s);
+    }
+    block.stmts = arena.list(pending.data() + start, pending.size() - start);
+    pending.resize(start);
+}
+
+void LoopOptimizer::markWrites(const Block& block) {
+    for (const StmtPtr& s : block.stmts) {
+        if (s->kind == Stmt::Decl || s->kind == Stmt::Assign || s->kind == Stmt::SetIndex) written[s->slot] = true;
+        markWrites(s->body);
+        markWrites(s->elseBody);
+    }
+}
+
+bool LoopOptimizer::invariant(const Expr& e) const {
+    switch (e.kind) {
+    case Expr::Literal:
+        return true;
+    case Expr::Var:
+        return !written[e.slot];
+    case Expr::Binary:
+    case Expr::Index:
+        return invariant(*e.lhs) && invariant(*e.rhs);
+    case Expr::Call:
+        // funkce skriptu muze tisknout, jeji volani zustane na miste
+        return e.fn != Builtin::User && invariant(*e.lhs) && (!e.rhs || invariant(*e.rhs));
+    }
+    return false;
+}
+
+// Nahradi nejvetsi invariantni podvyrazy ctenim pomocneho slotu.
+void LoopOptimizer::hoistExpr(ExprPtr& e) {
+    if (e->kind == Expr::Literal || e->kind == Expr::Var) return;
+    Value::Type type = e->type;
+    if (!invariant(*e)) {
+        if (e->kind == Expr::Call && e->fn == Builtin::User) {
+            for (ExprPtr& a : e->args) hoistExpr(a);
+            return;
+        }
+        hoistExpr(e->lhs);
+        if (e->rhs) hoistExpr(e->rhs);
+        return;
+    }
+    StmtPtr decl = arena.make<Stmt>(Stmt::Decl);
+    decl->line = e->line;
+    decl->col = e->col;
+    decl->declType = type;
+    decl->slot = (int32_t)slots->size();
+    decl->name = arena.intern("$inv" + std::to_string(temps++));
+    slots->push_back({ std::string(decl->name), type });
+    isTemp.push_back(true);
+    written.push_back(false);
+
+    ExprPtr use = arena.make<Expr>(Expr::Var);
+    use->line = e->line;
+    use->col = e->col;
+    use->slot = decl->slot;
+    use->type = type;
+    use->name = decl->name;
+    decl->expr = e;
+    e = use;
+    pending.push_back(decl);
+}
+
+void LoopOptimizer::hoistBlock(Block& block) {
+    for (StmtPtr s : block.stmts) {
+        if (s->expr) hoistExpr(s->expr);
+        if (s->index) hoistExpr(s->index);
+        hoistBlock(s->body);
+        hoistBlock(s->elseBody);
+    }
+}
+
+void LoopOptimizer::hoistLoop(Stmt& loop) {
+    written.assign(slots->size(), false);
+    markWrites(loop.body);
+
+    // pomocne promenne vnorenych smycek, jejichz vyraz je invariantni i tady,
+    // se presunou ven cele (kazda se zapisuje jen ve sve deklaraci)
+    uint32_t kept = 0;
+    for (StmtPtr s : loop.body.stmts) {
+        if (s->kind == Stmt::Decl && isTemp[s->slot] && invariant(*s->expr)) {
+            written[s->slot] = false;
+            pending.push_back(s);
+            continue;
+        }
+        loop.body.stmts[kept++] = s;
+    }
+    loop.body.stmts.count = kept;
+
+    hoistExpr(loop.expr);
+    hoistBlock(loop.body);
+}
+
+static bool isIntVar(const Expr& e, const std::vector<SlotInfo>& slots) {
+    return e.kind == Expr::Var && slots[e.slot].type == Value::INT;
+}
+
+static bool isIntLiteral(const Expr& e) {
+    return e.kind == Expr::Literal && e.value.type == Value::INT;
+}
+
+// zatimco (i CMP mez) { ...; i = i +- k } s i a mezi typu cele_cislo
+// a konstantnim krokem k, ktery se vejde do operandu instrukce.
+void LoopOptimizer::detectCounted(Stmt& loop) const {
+    const std::vector<SlotInfo>& si = *slots;
+    if (loop.body.stmts.empty()) return;
+    const Stmt& inc = *loop.body.stmts.back();
+    if (inc.kind != Stmt::Assign || si[inc.slot].type != Value::INT) return;
+    const Expr& step = *inc.expr;
+    if (step.kind != Expr::Binary || (step.op != BinOp::Add && step.op != BinOp::Sub)) return;
+    const Expr* k = nullptr;
+    if (step.lhs->kind == Expr::Var && step.lhs->slot == inc.slot) k = step.rhs;
+    else if (step.op == BinOp::Add && step.rhs->kind == Expr::Var && step.rhs->slot == inc.slot) k = step.lhs;
+    if (!k || !isIntLiteral(*k) || k->value.i == 0 || k->value.i <= INT32_MIN || k->value.i > INT32_MAX) return;
+    int32_t by = (int32_t)(step.op == BinOp::Add ? k->value.i : -k->value.i);
+
+    Expr& cond = *loop.expr;
+    if (cond.kind != Expr::Binary || cond.op == BinOp::Eq || !isComparison(cond.op)) return;
+    bool left = cond.lhs->kind == Expr::Var && cond.lhs->slot == inc.slot;
+    bool right = cond.rhs->kind == Expr::Var && cond.rhs->slot == inc.slot;
+    const Expr& limit = left ? *cond.rhs : *cond.lhs;
+    if (!(left || right) || (!isIntVar(limit, si) && !isIntLiteral(limit))) return;
+    if (!left) {
+        // mez < i  ->  i > mez
+        std::swap(cond.lhs, cond.rhs);
+        switch (cond.op) {
+        case BinOp::Lt: cond.op = BinOp::Gt; break;
+        case BinOp::Le: cond.op = BinOp::Ge; break;
+        case BinOp::Gt: cond.op = BinOp::Lt; break;
+        case BinOp::Ge: cond.op = BinOp::Le; break;
+        default: break;
+        }
+    }
+    loop.step = by;
+}
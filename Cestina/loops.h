@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "ast.h"
+
+// Optimalizace smycek zatimco (vola ji Optimizer na konci):
+//  - vytazeni invariantnich podvyrazu pred smycku do pomocnych slotu.
+//    Po TypeCheckeru zadny vyraz nemuze skoncit chybou, takze jejich
+//    vyhodnoceni navic (i kdyz smycka neprobehne) nic nezmeni,
+//  - rozpoznani pocitane smycky zatimco (i < mez) { ...; i = i + k },
+//    kterou Compiler prelozi na jedinou instrukci FOR_* na konci tela.
+// Vnorene smycky se zpracuji drive nez vnejsi, takze invariant muze
+// postupne probublat az ven.
+class LoopOptimizer {
+public:
+    explicit LoopOptimizer(Arena& arena) : arena(arena) {}
+    void optimize(Block& program, std::vector<SlotInfo>& slots);
+
+private:
+    Arena& arena;
+    std::vector<SlotInfo>* slots = nullptr;
+    std::vector<StmtPtr> pending; // prestavovane bloky a vytazene deklarace, viz Parser::finishBlock
+    std::vector<bool> isTemp;  // slot je pomocna promenna pro vytazeny vyraz
+    std::vector<bool> written; // slot se zapisuje v prave zpracovavane smycce
+    uint32_t temps = 0;
+
+    void visitBlock(Block& block);
+    void markWrites(const Block& block);
+    bool invariant(const Expr& e) const;
+    void hoistExpr(ExprPtr& e);
+    void hoistBlock(Block& block);
+    void hoistLoop(Stmt& loop);
+    void detectCounted(Stmt& loop) const;
+};
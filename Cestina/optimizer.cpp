@@ -0,0 +1,120 @@
+#include "optimizer.h"
+#include "loops.h"
+
+void Optimizer::optimize(Block& program, std::vector<SlotInfo>& slotInfo, const std::vector<int32_t>& live) {
+    for (StmtPtr s : program.stmts)
+        if (s->kind == Stmt::Func) optimize(s->func->body, s->func->slots);
+    foldBlock(program);
+    reads.assign(slotInfo.size(), 0);
+    for (int32_t slot : live) reads[slot]++;
+    countBlock(program);
+    // odstraneni jedne deklarace muze uvolnit promenne z jejiho inicializatoru
+    while (removeUnused(program)) {}
+    LoopOptimizer(arena).optimize(program, slotInfo);
+}
+
+static bool callsFunction(const Expr& e) {
+    switch (e.kind) {
+    case Expr::Literal:
+    case Expr::Var:
+        return false;
+    case Expr::Binary:
+    case Expr::Index:
+        return callsFunction(*e.lhs) || callsFunction(*e.rhs);
+    case Expr::Call:
+        return e.fn == Builtin::User || callsFunction(*e.lhs) || (e.rhs && callsFunction(*e.rhs));
+    }
+    return false;
+}
+
+void Optimizer::foldExpr(Expr& e) {
+    if (e.kind == Expr::Literal || e.kind == Expr::Var) return;
+    if (e.kind == Expr::Call && e.fn == Builtin::User) {
+        for (ExprPtr a : e.args) foldExpr(*a);
+        return;
+    }
+    foldExpr(*e.lhs);
+    if (e.rhs) foldExpr(*e.rhs);
+    if (e.kind != Expr::Binary || e.lhs->kind != Expr::Literal || e.rhs->kind != Expr::Literal) return;
+    Value out;
+    if (!evalBinary(e.op, e.lhs->value, e.rhs->value, out)) return;
+    e.kind = Expr::Literal;
+    e.value = out;
+    e.lhs = nullptr;
+    e.rhs = nullptr;
+}
+
+void Optimizer::foldBlock(Block& block) {
+    size_t start = pending.size();
+    for (StmtPtr s : block.stmts) {
+        if (s->expr) foldExpr(*s->expr);
+        if (s->index) foldExpr(*s->index);
+        if (s->kind == Stmt::If && s->expr->kind == Expr::Literal) {
+            // sloty uz jsou pridelene, telo vetve lze vlozit primo do nadrazeneho bloku
+            Block& taken = truthy(s->expr->value) ? s->body : s->elseBody;
+            foldBlock(taken);
+            for (StmtPtr inner : taken.stmts) pending.push_back(inner);
+            continue;
+        }
+        if (s->kind == Stmt::While && s->expr->kind == Expr::Literal && !truthy(s->expr->value)) continue;
+        if (s->kind == Stmt::If || s->kind == Stmt::While) {
+            foldBlock(s->body);
+            foldBlock(s->elseBody);
+        }
+        pending.push_back(s);
+    }
+    block.stmts = arena.list(pending.data() + start, pending.size() - start);
+    pending.resize(start);
+}
+
+void Optimizer::countReads(const Expr& e, int delta, int32_t self) {
+    switch (e.kind) {
+    case Expr::Literal:
+        return;
+    case Expr::Var:
+        if (e.slot != self) reads[e.slot] += delta;
+        return;
+    case Expr::Binary:
+    case Expr::Index:
+        countReads(*e.lhs, delta, self);
+        countReads(*e.rhs, delta, self);
+        return;
+    case Expr::Call:
+        if (e.fn != Builtin::User) {
+            countReads(*e.lhs, delta, self);
+            if (e.rhs) countReads(*e.rhs, delta, self);
+        }
+        else for (ExprPtr a : e.args) countReads(*a, delta, self);
+        return;
+    }
+}
+
+void Optimizer::countBlock(const Block& block) {
+    for (const StmtPtr& s : block.stmts) {
+        if (s->expr) countReads(*s->expr, 1, s->kind == Stmt::Assign ? s->slot : -1);
+        if (s->index) countReads(*s->index, 1);
+        // zapis do prvku pole (slovniku) neodstranujeme, pocita se jako jeho cteni
+        if (s->kind == Stmt::SetIndex) reads[s->slot]++;
+        countBlock(s->body);
+        countBlock(s->elseBody);
+    }
+}
+
+// blok se jen zkracuje, prikazy se posouvaji na miste
+bool Optimizer::removeUnused(Block& block) {
+    bool changed = false;
+    uint32_t kept = 0;
+    for (StmtPtr s : block.stmts) {
+        if ((s->kind == Stmt::Decl || s->kind == Stmt::Assign) && reads[s->slot] == 0 && !(s->expr && callsFunction(*s->expr))) {
+            if (s->expr) countReads(*s->expr, -1, s->kind == Stmt::Assign ? s->slot : -1);
+            if (s->index) countReads(*s->index, -1);
+            changed = true;
+            continue;
+        }
+        changed |= removeUnused(s->body);
+        changed |= removeUnused(s->elseBody);
+        block.stmts[kept++] = s;
+    }
+    block.stmts.count = kept;
+    return changed;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "ast.h"
+
+// Optimalizace nad vyresenym a typove zkontrolovanym AST (po TypeCheckeru):
+//  - skladani konstantnich podvyrazu se stejnym povysovanim typu jako za behu,
+//  - odstraneni vetvi pokud/zatimco s konstantni podminkou,
+//  - odstraneni deklaraci a prirazeni promennych, ktere se nikdy nectou,
+//  - smycky, viz LoopOptimizer (muze pridat pomocne sloty).
+// Telo kazde funkce ma vlastni sloty a optimalizuje se samostatne.
+// Volani funkce muze tisknout, prirazeni s nim se proto neodstranuje.
+// Typove chyby uz nahlasil TypeChecker, vyhodnoceni zadneho vyrazu proto
+// nemuze selhat a vystup programu se nemeni.
+class Optimizer {
+public:
+    // nove pole prikazu (a pomocne uzly LoopOptimizeru) jdou do areny s AST
+    explicit Optimizer(Arena& arena) : arena(arena) {}
+    // live: sloty, ktere se ctou i po konci programu (dalsi beh inkrementalniho REPL)
+    void optimize(Block& program, std::vector<SlotInfo>& slots, const std::vector<int32_t>& live = {});
+
+private:
+    Arena& arena;
+    std::vector<StmtPtr> pending; // prestavovane bloky, viz Parser::finishBlock
+    std::vector<uint32_t> reads; // kolikrat se ktery slot cte (mimo zapisy do sebe sama, x = x + 1)
+
+    void foldExpr(Expr& e);
+    void foldBlock(Block& block);
+    void countReads(const Expr& e, int delta, int32_t self = -1);
+    void countBlock(const Block& block);
+    bool removeUnused(Block& block);
+};
@@ -0,0 +1,64 @@
+#include "output.h"
+#include <cerrno>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+void OutputSink::writeSlow(std::string_view s) {
+    // doplnit buffer, odeslat a zbytek bud rovnou, nebo zase do bufferu
+    size_t n = BufferSize - len;
+    std::memcpy(buf + len, s.data(), n);
+    emit(buf, BufferSize);
+    len = 0;
+    s.remove_prefix(n);
+    if (s.size() >= BufferSize) emit(s.data(), s.size());
+    else { std::memcpy(buf, s.data(), s.size()); len = s.size(); }
+}
+
+// [1, 2, 3], prvky ve stejnem formatu jako samostatna cisla
+void OutputSink::writeArray(const Value& v) {
+    char tmp[32];
+    write("[");
+    for (size_t k = 0; k < v.arr->len; k++) {
+        if (k) write(", ");
+        write(v.element(k).format(tmp));
+    }
+    write("]");
+}
+
+// {1: 5, "jablko": 3} v poradi vkladani, stejne jako Value::toString
+void OutputSink::writeDict(const Value& v) {
+    char tmp[32];
+    write("{");
+    for (uint32_t k = 0; k < v.dict->len; k++) {
+        const DictEntry& e = v.dict->entries[k];
+        if (k) write(", ");
+        if (e.hash & 1) {
+            write("\"");
+            write(e.key.s->view());
+            write("\"");
+        }
+        else write(Value::make_int(e.key.i).format(tmp));
+        write(": ");
+        write((v.type == Value::DICT_INT ? Value::make_int(e.value.i) : Value::make_float(e.value.f)).format(tmp));
+    }
+    write("}");
+}
+
+void FdSink::emit(const char* data, size_t n) {
+    while (n > 0) {
+#ifdef _WIN32
+        int w = _write(fd, data, (unsigned)n);
+#else
+        ssize_t w = ::write(fd, data, n);
+#endif
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return; // zavreny vystup, neni komu hlasit chybu
+        }
+        data += w;
+        n -= (size_t)w;
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "value.h"
+
+// Kam jde vystup prikazu tiskni. Zapisy se skladaji do pevneho bufferu a
+// ven se posilaji az pri jeho zaplneni nebo pri flush(), takze i program,
+// ktery tiskne miliony radku, ma konstantni pametovou narocnost.
+class OutputSink {
+public:
+    static constexpr size_t BufferSize = 8192;
+
+    OutputSink() = default;
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+    // potomci musi zavolat flush() ve vlastnim destruktoru, tady uz je pozde
+    virtual ~OutputSink() = default;
+
+    void write(std::string_view s) {
+        if (s.size() > BufferSize - len) { writeSlow(s); return; }
+        std::memcpy(buf + len, s.data(), s.size());
+        len += s.size();
+    }
+    void writeValue(const Value& v) {
+        if (v.isArray()) { writeArray(v); return; }
+        if (v.isDict()) { writeDict(v); return; }
+        char tmp[32];
+        write(v.format(tmp));
+    }
+    // odesle vse, co je v bufferu
+    void flush() {
+        if (len) { emit(buf, len); len = 0; }
+        sync();
+    }
+
+protected:
+    virtual void emit(const char* data, size_t n) = 0;
+    virtual void sync() {}
+
+private:
+    char buf[BufferSize];
+    size_t len = 0;
+
+    void writeSlow(std::string_view s);
+    void writeArray(const Value& v);
+    void writeDict(const Value& v);
+};
+
+// std::ostream, napr. std::cout
+class StreamSink : public OutputSink {
+public:
+    explicit StreamSink(std::ostream& os) : os(os) {}
+    ~StreamSink() override { flush(); }
+
+protected:
+    void emit(const char* data, size_t n) override { os.write(data, (std::streamsize)n); }
+    void sync() override { os.flush(); }
+
+private:
+    std::ostream& os;
+};
+
+// souborovy deskriptor (1 = stdout)
+class FdSink : public OutputSink {
+public:
+    explicit FdSink(int fd) : fd(fd) {}
+    ~FdSink() override { flush(); }
+
+protected:
+    void emit(const char* data, size_t n) override;
+
+private:
+    int fd;
+};
+
+// libovolna funkce hostitele
+class CallbackSink : public OutputSink {
+public:
+    explicit CallbackSink(std::function<void(std::string_view)> fn) : fn(std::move(fn)) {}
+    ~CallbackSink() override { flush(); }
+
+protected:
+    void emit(const char* data, size_t n) override { fn(std::string_view(data, n)); }
+
+private:
+    std::function<void(std::string_view)> fn;
+};
+
+// do pameti; pouziva Interpreter::run, ktery vraci std::string
+class StringSink : public OutputSink {
+public:
+    explicit StringSink(std::string& out) : out(out) {}
+    ~StringSink() override { flush(); }
+
+protected:
+    void emit(const char* data, size_t n) override { out.append(data, n); }
+
+private:
+    std::string& out;
+};
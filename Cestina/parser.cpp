@@ -0,0 +1,392 @@
+#include "parser.h"
+
+ExprPtr Parser::makeExpr(Expr::Kind kind, const Token& at) {
+    ExprPtr e = arena.make<Expr>(kind);
+    e->line = at.line;
+    e->col = at.col;
+    return e;
+}
+
+StmtPtr Parser::makeStmt(Stmt::Kind kind, const Token& at) {
+    StmtPtr s = arena.make<Stmt>(kind);
+    s->line = at.line;
+    s->col = at.col;
+    return s;
+}
+
+bool Parser::consumeIf(Tok kind) {
+    if (toks[pos].kind == kind) { pos++; return true; }
+    return false;
+}
+
+const Token& Parser::expect(Tok kind) {
+    const Token& t = toks[pos];
+    if (t.kind != kind) throw std::string("Ocekavano '") + tokName(kind) + "'" + tokPos(t);
+    pos++;
+    return t;
+}
+
+std::string_view Parser::parseIdent() {
+    const Token& t = toks[pos];
+    if (t.kind != Tok::Ident) throw std::string("Ocekavan identifikator") + tokPos(t);
+    pos++;
+    return t.text;
+}
+
+// Expr := Sum [ (<|<=|>|>=|==|!=) Sum ]
+ExprPtr Parser::parseExpression() {
+    ExprPtr v = parseSum();
+    BinOp op;
+    switch (peek().kind) {
+    case Tok::Lt: op = BinOp::Lt; break;
+    case Tok::Le: op = BinOp::Le; break;
+    case Tok::Gt: op = BinOp::Gt; break;
+    case Tok::Ge: op = BinOp::Ge; break;
+    case Tok::Eq: op = BinOp::Eq; break;
+    case Tok::Ne: op = BinOp::Ne; break;
+    default: return v;
+    }
+    ExprPtr e = makeExpr(Expr::Binary, toks[pos++]);
+    e->op = op;
+    e->lhs = v;
+    e->rhs = parseSum();
+    return e;
+}
+
+// Sum := Term { (+|-) Term }
+ExprPtr Parser::parseSum() {
+    ExprPtr v = parseTerm();
+    while (check(Tok::Plus) || check(Tok::Minus)) {
+        const Token& opTok = toks[pos++];
+        ExprPtr e = makeExpr(Expr::Binary, opTok);
+        e->op = opTok.kind == Tok::Plus ? BinOp::Add : BinOp::Sub;
+        e->lhs = v;
+        e->rhs = parseTerm();
+        v = e;
+    }
+    return v;
+}
+
+// Term := Factor { (*|/) Factor }
+ExprPtr Parser::parseTerm() {
+    ExprPtr v = parseFactor();
+    while (check(Tok::Star) || check(Tok::Slash)) {
+        const Token& opTok = toks[pos++];
+        ExprPtr e = makeExpr(Expr::Binary, opTok);
+        e->op = opTok.kind == Tok::Star ? BinOp::Mul : BinOp::Div;
+        e->lhs = v;
+        e->rhs = parseFactor();
+        v = e;
+    }
+    return v;
+}
+
+// Factor := number | string | identifier | ident(expr) | (expr) | boolean literals,
+// za identifikatorem a zavorkou muze byt index [expr]
+ExprPtr Parser::parseFactor() {
+    const Token& t = toks[pos];
+    switch (t.kind) {
+    case Tok::LParen: {
+        pos++;
+        ExprPtr v = parseExpression();
+        expect(Tok::RParen);
+        return parseIndex(v);
+    }
+    case Tok::String: {
+        pos++;
+        // escape sekvence jen zkracuji, staci docasny buffer v arene
+        char* s = static_cast<char*>(arena.allocate(t.text.size() + 1, 1));
+        size_t n = 0;
+        for (size_t k = 0; k < t.text.size(); k++) {
+            char c = t.text[k];
+            if (c == '\\' && k + 1 < t.text.size()) {
+                char next = t.text[++k];
+                if (next == 'n') s[n++] = '\n';
+                else if (next == 't') s[n++] = '\t';
+                else s[n++] = next;
+            }
+            else s[n++] = c;
+        }
+        ExprPtr e = makeExpr(Expr::Literal, t);
+        e->value = Value::make_string(std::string_view(s, n));
+        return e;
+    }
+    case Tok::Plus:
+    case Tok::Minus:
+    case Tok::Number: {
+        // znamenko patri k ciselnemu literalu, stejne jako drive v parseNumber
+        bool neg = false;
+        if (t.kind != Tok::Number) {
+            neg = t.kind == Tok::Minus;
+            pos++;
+            if (!check(Tok::Number)) throw std::string("Ocekavano cislo") + tokPos(peek());
+        }
+        const Token& n = toks[pos++];
+        ExprPtr e = makeExpr(Expr::Literal, t);
+        if (n.isInt) e->value = Value::make_int(neg ? -n.i : n.i);
+        else e->value = Value::make_float(neg ? -n.f : n.f);
+        return e;
+    }
+    case Tok::Pravda:
+    case Tok::Nepravda: {
+        pos++;
+        ExprPtr e = makeExpr(Expr::Literal, t);
+        e->value = Value::make_bool(t.kind == Tok::Pravda);
+        return e;
+    }
+    case Tok::Ident: {
+        pos++;
+        if (consumeIf(Tok::LParen)) return parseIndex(parseCall(t));
+        ExprPtr e = makeExpr(Expr::Var, t);
+        e->name = arena.intern(t.text);
+        return parseIndex(e);
+    }
+    default:
+        throw std::string("Ocekavan vyraz") + tokPos(t);
+    }
+}
+
+static bool builtin(std::string_view name, Builtin& fn) {
+    if (name == "soucet") fn = Builtin::Soucet;
+    else if (name == "minimum") fn = Builtin::Minimum;
+    else if (name == "maximum") fn = Builtin::Maximum;
+    else if (name == "delka") fn = Builtin::Delka;
+    else if (name == "obsahuje") fn = Builtin::Obsahuje;
+    else return false;
+    return true;
+}
+
+// name ( [expr {, expr}] ) -- uvodni '(' uz je zkonzumovana. Vestavena
+// funkce ma jeden argument (obsahuje dva), ostatni jmena jsou funkce
+// skriptu (overi Resolver).
+ExprPtr Parser::parseCall(const Token& name) {
+    ExprPtr e = makeExpr(Expr::Call, name);
+    if (builtin(name.text, e->fn)) {
+        e->lhs = parseExpression();
+        if (e->fn == Builtin::Obsahuje) {
+            expect(Tok::Comma);
+            e->rhs = parseExpression();
+        }
+        expect(Tok::RParen);
+        return e;
+    }
+    e->fn = Builtin::User;
+    e->name = arena.intern(name.text);
+    size_t start = argBuf.size();
+    if (!check(Tok::RParen)) {
+        do argBuf.push_back(parseExpression());
+        while (consumeIf(Tok::Comma));
+    }
+    expect(Tok::RParen);
+    e->args = arena.list(argBuf.data() + start, argBuf.size() - start);
+    argBuf.resize(start);
+    return e;
+}
+
+// v [expr]
+ExprPtr Parser::parseIndex(ExprPtr v) {
+    while (check(Tok::LBracket)) {
+        ExprPtr e = makeExpr(Expr::Index, toks[pos++]);
+        e->lhs = v;
+        e->rhs = parseExpression();
+        expect(Tok::RBracket);
+        v = e;
+    }
+    return v;
+}
+
+// Statements: jednoducha sekvence, strednik na konci je volitelny
+Block Parser::parseProgram() {
+    size_t start = pending.size();
+    while (!check(Tok::End)) {
+        if (consumeIf(Tok::Semicolon)) continue;
+        StmtPtr s = check(Tok::Funkce) ? parseFunction() : parseStatement();
+        pending.push_back(s);
+    }
+    return finishBlock(start);
+}
+
+// { stmts } -- uvodni '{' uz je zkonzumovana
+Block Parser::parseBlock() {
+    size_t start = pending.size();
+    while (!consumeIf(Tok::RBrace)) {
+        if (check(Tok::End)) throw std::string("Ocekavano '}'") + tokPos(peek());
+        if (consumeIf(Tok::Semicolon)) continue;
+        StmtPtr s = parseStatement();
+        pending.push_back(s);
+    }
+    return finishBlock(start);
+}
+
+// Vnorene bloky se parsuji na konec pending a hned se z nej zase odeberou,
+// prikazy bloku proto lezi od start az do konce.
+Block Parser::finishBlock(size_t start) {
+    Block block;
+    block.stmts = arena.list(pending.data() + start, pending.size() - start);
+    pending.resize(start);
+    return block;
+}
+
+// typ promenne: cele_cislo | plout | boolean | pole cele_cislo | pole plout
+//   | slovnik cele_cislo | slovnik plout
+bool Parser::parseType(Value::Type& type) {
+    if (consumeIf(Tok::CeleCislo)) type = Value::INT;
+    else if (consumeIf(Tok::Plout)) type = Value::FLOAT;
+    else if (consumeIf(Tok::Boolean)) type = Value::BOOL;
+    else if (check(Tok::Pole) || check(Tok::Slovnik)) type = parseContainer();
+    else return false;
+    return true;
+}
+
+// pole|slovnik cele_cislo|plout
+Value::Type Parser::parseContainer() {
+    bool dict = toks[pos++].kind == Tok::Slovnik;
+    if (consumeIf(Tok::CeleCislo)) return dict ? Value::DICT_INT : Value::ARRAY_INT;
+    if (consumeIf(Tok::Plout)) return dict ? Value::DICT_FLOAT : Value::ARRAY_FLOAT;
+    throw std::string(dict ? "Ocekavan typ hodnot slovniku (cele_cislo nebo plout)"
+        : "Ocekavan typ prvku pole (cele_cislo nebo plout)") + tokPos(peek());
+}
+
+// funkce [typ] ident ( [typ ident {, typ ident}] ) { ... }
+// Bez typu funkce nevraci hodnotu.
+StmtPtr Parser::parseFunction() {
+    const Token& t = toks[pos++];
+    StmtPtr s = makeStmt(Stmt::Func, t);
+    FuncDef* f = arena.make<FuncDef>();
+    f->line = t.line;
+    f->col = t.col;
+    parseType(f->ret);
+    const Token& nameTok = peek();
+    f->name = arena.intern(parseIdent());
+    Builtin fn;
+    if (builtin(f->name, fn)) throw std::string("Funkce ") + std::string(f->name) + " je vestavena" + tokPos(nameTok);
+    expect(Tok::LParen);
+    std::vector<Param> params;
+    if (!check(Tok::RParen)) {
+        do {
+            Param p;
+            p.line = peek().line;
+            p.col = peek().col;
+            if (!parseType(p.type)) throw std::string("Ocekavan typ parametru") + tokPos(peek());
+            p.name = arena.intern(parseIdent());
+            params.push_back(p);
+        } while (consumeIf(Tok::Comma));
+    }
+    expect(Tok::RParen);
+    f->params = arena.list(params.data(), params.size());
+    expect(Tok::LBrace);
+    current = f;
+    f->body = parseBlock();
+    current = nullptr;
+    s->name = f->name;
+    s->func = f;
+    return s;
+}
+
+StmtPtr Parser::parseStatement() {
+    const Token& t = peek();
+    switch (t.kind) {
+    case Tok::CeleCislo:
+    case Tok::Plout:
+    case Tok::Boolean: {
+        // deklarace: typ ident [= expr] ;
+        pos++;
+        StmtPtr s = makeStmt(Stmt::Decl, t);
+        s->declType = t.kind == Tok::CeleCislo ? Value::INT : t.kind == Tok::Plout ? Value::FLOAT : Value::BOOL;
+        s->name = arena.intern(parseIdent());
+        if (consumeIf(Tok::Assign)) s->expr = parseExpression();
+        // optional semicolon
+        consumeIf(Tok::Semicolon);
+        return s;
+    }
+
+    // pole: pole typ ident [ '[' velikost ']' | = expr ] ;
+    // slovnik: slovnik typ ident [ '[' rezerva ']' | = expr ] ;
+    case Tok::Pole:
+    case Tok::Slovnik: {
+        StmtPtr s = makeStmt(Stmt::Decl, t);
+        s->declType = parseContainer();
+        s->name = arena.intern(parseIdent());
+        if (consumeIf(Tok::LBracket)) {
+            s->index = parseExpression();
+            expect(Tok::RBracket);
+        }
+        else if (consumeIf(Tok::Assign)) s->expr = parseExpression();
+        consumeIf(Tok::Semicolon);
+        return s;
+    }
+
+    // tiskni expr ;
+    case Tok::Tiskni: {
+        pos++;
+        StmtPtr s = makeStmt(Stmt::Print, t);
+        s->expr = parseExpression();
+        consumeIf(Tok::Semicolon);
+        return s;
+    }
+
+    // prirazeni: ident [ '[' index ']' ] = expr ;  nebo volani: ident ( ... ) ;
+    case Tok::Ident: {
+        pos++;
+        StmtPtr s;
+        if (consumeIf(Tok::LParen)) {
+            s = makeStmt(Stmt::Eval, t);
+            s->expr = parseCall(t);
+            consumeIf(Tok::Semicolon);
+            return s;
+        }
+        if (consumeIf(Tok::LBracket)) {
+            s = makeStmt(Stmt::SetIndex, t);
+            s->index = parseExpression();
+            expect(Tok::RBracket);
+        }
+        else s = makeStmt(Stmt::Assign, t);
+        expect(Tok::Assign);
+        s->name = arena.intern(t.text);
+        s->expr = parseExpression();
+        consumeIf(Tok::Semicolon);
+        return s;
+    }
+
+    // pokud ( expr ) { ... } [jinak { ... }]
+    case Tok::Pokud: {
+        pos++;
+        StmtPtr s = makeStmt(Stmt::If, t);
+        expect(Tok::LParen); s->expr = parseExpression(); expect(Tok::RParen);
+        expect(Tok::LBrace); s->body = parseBlock();
+        if (consumeIf(Tok::Jinak)) {
+            expect(Tok::LBrace);
+            s->elseBody = parseBlock();
+            s->hasElse = true;
+        }
+        return s;
+    }
+
+    // zatimco ( expr ) { ... }
+    case Tok::Zatimco: {
+        pos++;
+        StmtPtr s = makeStmt(Stmt::While, t);
+        expect(Tok::LParen); s->expr = parseExpression(); expect(Tok::RParen);
+        expect(Tok::LBrace); s->body = parseBlock();
+        return s;
+    }
+
+    // vrat [expr] ; -- hodnotu ma jen funkce s typem, jinak by vrat na
+    // konci radku spolklo nasledujici prikaz
+    case Tok::Vrat: {
+        if (!current) throw std::string("vrat mimo funkci") + tokPos(t);
+        pos++;
+        StmtPtr s = makeStmt(Stmt::Return, t);
+        if (current->ret != Value::NONE) s->expr = parseExpression();
+        consumeIf(Tok::Semicolon);
+        return s;
+    }
+
+    case Tok::Funkce:
+        throw std::string("Funkce lze definovat jen na nejvyssi urovni") + tokPos(t);
+
+    default:
+        // unknown token
+        throw std::string("Neznamy statement") + tokPos(t);
+    }
+}
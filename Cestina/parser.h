@@ -0,0 +1,45 @@
+#pragma once
+#include <string_view>
+#include <vector>
+#include "ast.h"
+#include "lexer.h"
+
+// Stavi AST z tokenu lexeru do areny. Nic nevykonava.
+class Parser {
+public:
+    Parser(const std::vector<Token>& toks, Arena& arena) : toks(toks), arena(arena) {}
+    Block parseProgram();
+
+private:
+    const std::vector<Token>& toks;
+    Arena& arena;
+    size_t pos = 0;
+    std::vector<StmtPtr> pending; // prikazy rozparsovanych bloku, nez se zkopiruji do areny
+    std::vector<ExprPtr> argBuf;  // argumenty rozparsovanych volani, stejne jako pending
+    FuncDef* current = nullptr;   // prave parsovana funkce (vrat je jen v ni)
+
+    const Token& peek() const { return toks[pos]; }
+    bool check(Tok kind) const { return toks[pos].kind == kind; }
+    bool consumeIf(Tok kind);
+    const Token& expect(Tok kind);
+    std::string_view parseIdent();
+
+    // Expressions
+    ExprPtr parseExpression();
+    ExprPtr parseSum();
+    ExprPtr parseTerm();
+    ExprPtr parseFactor();
+    ExprPtr parseIndex(ExprPtr v);
+    ExprPtr parseCall(const Token& name);
+
+    ExprPtr makeExpr(Expr::Kind kind, const Token& at);
+    StmtPtr makeStmt(Stmt::Kind kind, const Token& at);
+
+    // Statements
+    StmtPtr parseStatement();
+    StmtPtr parseFunction();
+    bool parseType(Value::Type& type);
+    Value::Type parseContainer();
+    Block parseBlock();
+    Block finishBlock(size_t start);
+};
@@ -0,0 +1,76 @@
+#include "pool.h"
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = 1;
+    for (unsigned k = 0; k < threads; k++) queues.push_back(std::make_unique<Queue>());
+    for (unsigned k = 0; k < threads; k++) workers.emplace_back([this, k] { work(k); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stop = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    // pocitadla se zvysi driv, nez je uloha videt, at je nikdo neodecte do minusu
+    {
+        std::lock_guard<std::mutex> lock(m);
+        queued++;
+        unfinished++;
+    }
+    Queue& q = *queues[next++ % queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(q.m);
+        q.tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(m);
+    idle.wait(lock, [this] { return unfinished == 0; });
+}
+
+// Vlastni fronta od konce (naposledy pridane, teple v cache), cizi od zacatku.
+bool ThreadPool::take(size_t self, std::function<void()>& task) {
+    for (size_t k = 0; k < queues.size(); k++) {
+        Queue& q = *queues[(self + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(q.m);
+        if (q.tasks.empty()) continue;
+        if (k == 0) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        }
+        else {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::work(size_t self) {
+    std::function<void()> task;
+    for (;;) {
+        if (take(self, task)) {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                queued--;
+            }
+            task();
+            task = nullptr;
+            std::lock_guard<std::mutex> lock(m);
+            if (--unfinished == 0) idle.notify_all();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m);
+        // stop dokonci i ulohy, ktere jeste cekaji ve frontach
+        wake.wait(lock, [this] { return stop || queued > 0; });
+        if (stop && queued == 0) return;
+    }
+}
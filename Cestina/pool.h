@@ -0,0 +1,45 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pevny pocet vlaken s work stealingem: kazde vlakno ma vlastni frontu a
+// bere ulohy z jejiho konce; kdyz je prazdna, krade ze zacatku cizich.
+// Ulohy nesmi propustit vyjimku.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    // dokonci vsechny zadane ulohy
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+    // ceka, az dobehnou vsechny dosud zadane ulohy
+    void wait();
+    size_t size() const { return workers.size(); }
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    size_t next = 0; // fronta pro dalsi submit (jen z jednoho vlakna)
+
+    std::mutex m;
+    std::condition_variable wake; // prisla uloha nebo konec
+    std::condition_variable idle; // vse dobehlo
+    size_t queued = 0;            // ulohy ve frontach
+    size_t unfinished = 0;        // ulohy zadane a jeste nedobehle
+    bool stop = false;
+
+    bool take(size_t self, std::function<void()>& task);
+    void work(size_t self);
+};
@@ -0,0 +1,125 @@
+#include "profile.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <utility>
+
+// Kazdy radek pokryva usek instrukci: prikazy, ktere na nem zacinaji
+// (vcetne celeho tela), a jednotlive instrukce s pozici na nem.
+void InstrProfile::start(const Chunk& chunk) {
+    size_t n = chunk.code.size();
+    counts.assign(n, 0);
+    nanos.assign(n, 0);
+    std::map<uint32_t, uint32_t> dense;
+    std::vector<std::vector<uint32_t>> per(n);
+    auto cover = [&](size_t k, uint32_t line) {
+        auto it = dense.emplace(line, (uint32_t)dense.size()).first;
+        if (std::find(per[k].begin(), per[k].end(), it->second) == per[k].end()) per[k].push_back(it->second);
+    };
+    for (size_t k = 0; k < n; k++)
+        if (chunk.positions[k].line) cover(k, chunk.positions[k].line); // HALT ma radek 0
+    for (const StmtRange& s : chunk.stmts)
+        for (int32_t k = s.begin; k < s.end; k++) cover((size_t)k, s.line);
+    lines.assign(dense.size(), 0);
+    for (const auto& [line, id] : dense) lines[id] = line;
+    coverAt.assign(1, 0);
+    covers.clear();
+    for (const std::vector<uint32_t>& c : per) {
+        covers.insert(covers.end(), c.begin(), c.end());
+        coverAt.push_back((uint32_t)covers.size());
+    }
+    inclusive.assign(dense.size(), 0);
+    active.assign(dense.size(), 0);
+    since.assign(dense.size(), 0);
+    sites.clear();
+}
+
+void InstrProfile::call(size_t k, uint64_t now) {
+    sites.push_back((uint32_t)k);
+    for (uint32_t j = coverAt[k]; j < coverAt[k + 1]; j++)
+        if (active[covers[j]]++ == 0) since[covers[j]] = now;
+}
+
+void InstrProfile::ret(uint64_t now) {
+    size_t k = sites.back();
+    sites.pop_back();
+    for (uint32_t j = coverAt[k]; j < coverAt[k + 1]; j++)
+        if (--active[covers[j]] == 0) inclusive[covers[j]] += now - since[covers[j]];
+}
+
+void InstrProfile::finish(uint64_t now) {
+    while (!sites.empty()) ret(now);
+}
+
+ProfileReport ProfileReport::build(const Chunk& chunk, const InstrProfile& prof) {
+    ProfileReport r;
+    size_t n = chunk.code.size();
+    uint64_t total = 0;
+    std::map<uint32_t, Line> lines;
+    for (size_t k = 0; k < n; k++) {
+        total += prof.nanos[k];
+        uint32_t line = chunk.positions[k].line;
+        if (line) lines[line].exclusive += prof.nanos[k] * 1e-9;
+    }
+    r.total = total * 1e-9;
+    for (const StmtRange& s : chunk.stmts)
+        if (s.begin < s.end) lines[s.line].count += prof.counts[s.begin];
+    for (size_t id = 0; id < prof.lines.size(); id++) lines[prof.lines[id]].inclusive = prof.inclusive[id] * 1e-9;
+    for (auto& [line, l] : lines) {
+        l.line = line;
+        r.lines.push_back(l);
+    }
+
+    std::map<Op, OpCount> ops;
+    for (size_t k = 0; k < n; k++) {
+        if (!prof.counts[k]) continue;
+        OpCount& o = ops[chunk.code[k].op];
+        o.op = chunk.code[k].op;
+        o.count += prof.counts[k];
+        o.time += prof.nanos[k] * 1e-9;
+    }
+    for (const auto& [op, o] : ops) r.ops.push_back(o);
+    std::stable_sort(r.ops.begin(), r.ops.end(), [](const OpCount& a, const OpCount& b) { return a.count > b.count; });
+    return r;
+}
+
+std::string ProfileReport::toJson() const {
+    std::string out;
+    char buf[256];
+    std::snprintf(buf, sizeof buf, "{\n  \"total_ms\": %.3f,\n  \"lines\": [", total * 1e3);
+    out += buf;
+    for (size_t k = 0; k < lines.size(); k++) {
+        const Line& l = lines[k];
+        std::snprintf(buf, sizeof buf, "%s\n    {\"line\": %u, \"count\": %llu, \"inclusive_ms\": %.3f, \"exclusive_ms\": %.3f}",
+            k ? "," : "", l.line, (unsigned long long)l.count, l.inclusive * 1e3, l.exclusive * 1e3);
+        out += buf;
+    }
+    out += "\n  ],\n  \"ops\": [";
+    for (size_t k = 0; k < ops.size(); k++) {
+        const OpCount& o = ops[k];
+        std::snprintf(buf, sizeof buf, "%s\n    {\"op\": \"%s\", \"count\": %llu, \"ms\": %.3f}",
+            k ? "," : "", opName(o.op), (unsigned long long)o.count, o.time * 1e3);
+        out += buf;
+    }
+    out += "\n  ]\n}\n";
+    return out;
+}
+
+std::string ProfileReport::toTable(const std::vector<std::string>* source) const {
+    std::string out;
+    char buf[256];
+    std::snprintf(buf, sizeof buf, "Profil: celkem %.3f ms\n%5s %12s %12s %12s\n", total * 1e3, "radek", "pocet", "vcetne ms", "vlastni ms");
+    out += buf;
+    for (const Line& l : lines) {
+        std::snprintf(buf, sizeof buf, "%5u %12llu %12.3f %12.3f", l.line, (unsigned long long)l.count, l.inclusive * 1e3, l.exclusive * 1e3);
+        out += buf;
+        if (source && l.line <= source->size()) out += " | " + (*source)[l.line - 1];
+        out += '\n';
+    }
+    out += "Instrukce:\n";
+    for (const OpCount& o : ops) {
+        std::snprintf(buf, sizeof buf, "  %-14s %12llu %12.3f ms\n", opName(o.op), (unsigned long long)o.count, o.time * 1e3);
+        out += buf;
+    }
+    return out;
+}
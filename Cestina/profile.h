@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bytecode.h"
+
+// Surova data profilovaneho behu VM: kolikrat se ktera instrukce vykonala
+// a kolik nanosekund od ni trvalo, nez se dispatchovala dalsi.
+//
+// Vcetne cas se pocita po radcich (husta cisla, radek v lines) uz za behu.
+// Instrukce k patri radkum covers[coverAt[k] .. coverAt[k + 1]): svemu
+// a radkum prikazu, ktere ji obsahuji (i hlavicce funkce). Od CALL do
+// jeho RET se cely cas pricte radkum volani; radek, ze ktereho prave bezi
+// volani (i rekurzivni), se mezitim po instrukcich nepocita, at se cas
+// nezapocte dvakrat. Koncove volani prevezme frame, jeho cas tak patri
+// puvodnimu volani.
+struct InstrProfile {
+    std::vector<uint64_t> counts;
+    std::vector<uint64_t> nanos;
+
+    std::vector<uint32_t> lines;
+    std::vector<uint32_t> coverAt, covers;
+    std::vector<uint64_t> inclusive; // podle husteho cisla radku
+    std::vector<uint32_t> active;    // kolik volani z radku prave bezi
+    std::vector<uint64_t> since;     // kdy zacalo prvni z nich (ns)
+    std::vector<uint32_t> sites;     // instrukce CALL probihajicich volani
+
+    void start(const Chunk& chunk);
+    void step(size_t k, uint64_t ns) {
+        nanos[k] += ns;
+        for (uint32_t j = coverAt[k]; j < coverAt[k + 1]; j++)
+            if (!active[covers[j]]) inclusive[covers[j]] += ns;
+    }
+    void call(size_t k, uint64_t now);
+    void ret(uint64_t now);
+    // uzavre volani, ktera nedobehla (limit behu)
+    void finish(uint64_t now);
+};
+
+// Souhrn po radcich zdrojaku a po druzich instrukci.
+struct ProfileReport {
+    struct Line {
+        uint32_t line = 0;
+        uint64_t count = 0;     // kolikrat zacal prikaz na tomto radku
+        double inclusive = 0;   // s vnorenymi prikazy (telo pokud/zatimco) a volanymi funkcemi, v sekundach
+        double exclusive = 0;   // jen instrukce z tohoto radku
+    };
+    struct OpCount {
+        Op op = Op::HALT;
+        uint64_t count = 0;
+        double time = 0;
+    };
+    std::vector<Line> lines;  // jen radky s kodem, vzestupne
+    std::vector<OpCount> ops; // jen vykonane instrukce, sestupne podle poctu
+    double total = 0;
+
+    static ProfileReport build(const Chunk& chunk, const InstrProfile& prof);
+    std::string toJson() const;
+    // tabulka pro REPL; s radky zdrojaku, pokud jsou k dispozici
+    std::string toTable(const std::vector<std::string>* source = nullptr) const;
+};
@@ -0,0 +1,132 @@
+#include "resolver.h"
+
+std::vector<SlotInfo> Resolver::resolve(Block& program) {
+    Globals none;
+    return resolve(program, none);
+}
+
+std::vector<SlotInfo> Resolver::resolve(Block& program, Globals& globals, const std::vector<FuncDef*>& known) {
+    slots = globals.slots;
+    visible.clear();
+    scopes.clear();
+    for (const auto& [name, slot] : globals.names) visible[name].push_back(slot);
+    // funkci lze volat i pred jeji definici
+    funcs.clear();
+    for (FuncDef* f : known) funcs.emplace(f->name, f);
+    for (StmtPtr s : program.stmts) {
+        if (s->kind != Stmt::Func) continue;
+        if (!funcs.emplace(s->func->name, s->func).second)
+            throw std::string("Funkce uz existuje: ") + std::string(s->func->name) + nodePos(s->line, s->col);
+        s->func->index = (int32_t)funcs.size() - 1;
+    }
+    // nejvyssi uroven se nezavira, jeji jmena zustanou pro dalsi beh
+    scopes.emplace_back();
+    for (StmtPtr& s : program.stmts) resolveStmt(*s);
+    for (std::string_view name : scopes.back()) globals.names[std::string(name)] = visible[name].back();
+    scopes.pop_back();
+    return std::move(slots);
+}
+
+int32_t Resolver::lookup(std::string_view name) const {
+    auto it = visible.find(name);
+    if (it == visible.end() || it->second.empty()) return -1;
+    return it->second.back();
+}
+
+void Resolver::resolveBlock(Block& block) {
+    scopes.emplace_back();
+    for (StmtPtr& s : block.stmts) resolveStmt(*s);
+    for (std::string_view name : scopes.back()) visible[name].pop_back();
+    scopes.pop_back();
+}
+
+void Resolver::resolveExpr(Expr& e) {
+    switch (e.kind) {
+    case Expr::Literal:
+        return;
+    case Expr::Var:
+        e.slot = lookup(e.name);
+        if (e.slot < 0) throw std::string("Neznamy identifikator: ") + std::string(e.name) + nodePos(e.line, e.col);
+        return;
+    case Expr::Binary:
+    case Expr::Index:
+        resolveExpr(*e.lhs);
+        resolveExpr(*e.rhs);
+        return;
+    case Expr::Call: {
+        if (e.fn != Builtin::User) {
+            resolveExpr(*e.lhs);
+            if (e.rhs) resolveExpr(*e.rhs);
+            return;
+        }
+        for (ExprPtr a : e.args) resolveExpr(*a);
+        auto it = funcs.find(e.name);
+        if (it == funcs.end()) throw std::string("Neznama funkce: ") + std::string(e.name) + nodePos(e.line, e.col);
+        e.func = it->second;
+        return;
+    }
+    }
+}
+
+// Telo funkce vidi jen sve parametry a lokalni promenne, sloty cisluje od nuly.
+void Resolver::resolveFunction(FuncDef& f) {
+    std::vector<SlotInfo> outerSlots = std::move(slots);
+    auto outerVisible = std::move(visible);
+    auto outerScopes = std::move(scopes);
+    slots.clear();
+    visible.clear();
+    scopes.clear();
+    scopes.emplace_back();
+    for (const Param& p : f.params) {
+        if (lookup(p.name) >= 0) throw std::string("Parametr uz existuje: ") + std::string(p.name) + nodePos(p.line, p.col);
+        visible[p.name].push_back((int32_t)slots.size());
+        scopes.back().push_back(p.name);
+        slots.push_back({ std::string(p.name), p.type });
+    }
+    resolveBlock(f.body);
+    f.slots = std::move(slots);
+    slots = std::move(outerSlots);
+    visible = std::move(outerVisible);
+    scopes = std::move(outerScopes);
+}
+
+void Resolver::resolveStmt(Stmt& s) {
+    switch (s.kind) {
+    case Stmt::Decl: {
+        // inicializator jeste vidi pripadnou vnejsi promennou stejneho jmena
+        if (s.expr) resolveExpr(*s.expr);
+        if (s.index) resolveExpr(*s.index);
+        s.slot = (int32_t)slots.size();
+        slots.push_back({ std::string(s.name), s.declType });
+        visible[s.name].push_back(s.slot);
+        scopes.back().push_back(s.name);
+        return;
+    }
+    case Stmt::Assign:
+    case Stmt::SetIndex:
+        if (s.index) resolveExpr(*s.index);
+        resolveExpr(*s.expr);
+        s.slot = lookup(s.name);
+        if (s.slot < 0) throw std::string("Promenna neexistuje: ") + std::string(s.name) + nodePos(s.line, s.col);
+        return;
+    case Stmt::Print:
+        resolveExpr(*s.expr);
+        return;
+    case Stmt::If:
+        resolveExpr(*s.expr);
+        resolveBlock(s.body);
+        if (s.hasElse) resolveBlock(s.elseBody);
+        return;
+    case Stmt::While:
+        resolveExpr(*s.expr);
+        resolveBlock(s.body);
+        return;
+    case Stmt::Func:
+        resolveFunction(*s.func);
+        return;
+    case Stmt::Return:
+    case Stmt::Eval:
+        if (s.expr) resolveExpr(*s.expr);
+        return;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ast.h"
+
+// Priradi kazde promenne pevny slot v jednom plochem framu. Bloky pokud
+// a zatimco jsou lexikalni obory: promenne deklarovane uvnitr jsou videt
+// jen do konce bloku, ale ziji ve stejnem framu, nic se nekopiruje.
+// Telo funkce dostane vlastni frame (FuncDef::slots) a volani funkci
+// se navazou na jejich definice.
+class Resolver {
+public:
+    // Promenne nejvyssi urovne, ktere prezivaji mezi behy inkrementalniho
+    // REPL. Dalsi program na ne navazuje: vidi je a nove sloty dostane za nimi.
+    struct Globals {
+        std::vector<SlotInfo> slots;                    // vsechny dosud pridelene sloty
+        std::unordered_map<std::string, int32_t> names; // jmena viditelna na nejvyssi urovni
+    };
+
+    std::vector<SlotInfo> resolve(Block& program);
+    // navaze na globals a doplni do nich nova jmena nejvyssi urovne
+    // (globals.slots neaktualizuje, optimalizator jeste muze sloty pridat);
+    // known jsou funkce z minulych behu (jen hlavicky s indexy od nuly),
+    // nove funkce programu dostanou indexy za nimi
+    std::vector<SlotInfo> resolve(Block& program, Globals& globals, const std::vector<FuncDef*>& known = {});
+
+private:
+    std::vector<SlotInfo> slots;
+    std::unordered_map<std::string_view, std::vector<int32_t>> visible; // jmeno -> sloty, posledni je nejvnitrnejsi
+    std::vector<std::vector<std::string_view>> scopes;                  // jmena deklarovana v otevrenych blocich
+    std::unordered_map<std::string_view, FuncDef*> funcs;               // funkce programu podle jmena
+
+    int32_t lookup(std::string_view name) const;
+    void resolveBlock(Block& block);
+    void resolveStmt(Stmt& s);
+    void resolveExpr(Expr& e);
+    void resolveFunction(FuncDef& f);
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Limity jednoho behu pro neduveryhodne skripty, 0 = bez limitu. VM je
+// kontroluje na zpetnych skocich smycek (i v JIT), takze ani nekonecna
+// smycka nebezi dal nez do nejblizsi kontroly.
+struct RunLimits {
+    // Vykonane instrukce. Kazdy pruchod smyckou se pocita jako delka jejiho
+    // tela v bytecode, prikazy mimo smycky se nepocitaji (jsou omezene
+    // delkou programu).
+    uint64_t maxOps = 0;
+    double timeout = 0;                      // sekundy od zacatku behu
+    size_t maxMemory = 0;                    // bajty v polich a slovnicich vytvorenych behem
+    const std::atomic<bool>* cancel = nullptr; // host ho muze nastavit z jineho vlakna
+
+    bool any() const { return maxOps || timeout > 0 || maxMemory || cancel; }
+};
+
+// Proc beh skoncil predcasne.
+enum class LimitHit : uint8_t { None, Ops, Deadline, Memory, Cancelled };
+
+inline const char* limitMessage(LimitHit hit) {
+    switch (hit) {
+    case LimitHit::Ops: return "Prekrocen limit poctu instrukci";
+    case LimitHit::Deadline: return "Prekrocen casovy limit";
+    case LimitHit::Memory: return "Prekrocen limit pameti";
+    case LimitHit::Cancelled: return "Beh byl zrusen";
+    default: return "";
+    }
+}
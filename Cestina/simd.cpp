@@ -0,0 +1,394 @@
+#include "simd.h"
+#include <cstdlib>
+#include <cstring>
+
+// SSE2 je na x86-64 vzdy, AVX2 jen nekde: funkce s AVX2 se prekladaji
+// s atributem target a volaji se jen po kontrole procesoru. MSVC intrinsiky
+// povoluje i bez /arch, atribut nepotrebuje.
+#if defined(__x86_64__) || defined(_M_X64)
+#define CZPP_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CZPP_AVX2
+#else
+#define CZPP_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define CZPP_SIMD_X86 0
+#endif
+
+namespace simd {
+namespace {
+
+template <BinOp O>
+inline long long apply(long long x, long long y) {
+    if constexpr (O == BinOp::Add) return wrapAdd(x, y);
+    else if constexpr (O == BinOp::Sub) return wrapSub(x, y);
+    else if constexpr (O == BinOp::Mul) return wrapMul(x, y);
+    else return intDiv(x, y);
+}
+
+template <BinOp O>
+inline double apply(double x, double y) {
+    if constexpr (O == BinOp::Add) return x + y;
+    else if constexpr (O == BinOp::Sub) return x - y;
+    else if constexpr (O == BinOp::Mul) return x * y;
+    else return x / y;
+}
+
+// prvky od i do konce; vektorove verze jim predaji zbytek za posledni celou sirkou
+template <class T, BinOp O, Shape S>
+inline void tail(T* d, const T* a, const T* b, size_t i, size_t n) {
+    for (; i < n; i++) d[i] = apply<O>(S == ScalarArr ? a[0] : a[i], S == ArrScalar ? b[0] : b[i]);
+}
+
+template <BinOp O, Shape S>
+void scalarBinaryInt(long long* d, const long long* a, const long long* b, size_t n) {
+    tail<long long, O, S>(d, a, b, 0, n);
+}
+
+template <BinOp O, Shape S>
+void scalarBinaryFloat(double* d, const double* a, const double* b, size_t n) {
+    tail<double, O, S>(d, a, b, 0, n);
+}
+
+template <bool Max>
+inline double pick(double acc, double x) { return (Max ? x > acc : x < acc) ? x : acc; }
+
+long long scalarSumInt(const long long* a, size_t n) {
+    long long s = 0;
+    for (size_t i = 0; i < n; i++) s = wrapAdd(s, a[i]);
+    return s;
+}
+
+template <bool Max>
+long long scalarMinMaxInt(const long long* a, size_t n) {
+    if (n == 0) return 0;
+    long long r = a[0];
+    for (size_t i = 1; i < n; i++) r = (Max ? a[i] > r : a[i] < r) ? a[i] : r;
+    return r;
+}
+
+double scalarSumFloat(const double* a, size_t n) {
+    double l0 = 0, l1 = 0, l2 = 0, l3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        l0 += a[i];
+        l1 += a[i + 1];
+        l2 += a[i + 2];
+        l3 += a[i + 3];
+    }
+    double s = (l0 + l2) + (l1 + l3);
+    for (; i < n; i++) s += a[i];
+    return s;
+}
+
+template <bool Max>
+double finishMinMax(double r, const double* a, size_t i, size_t n) {
+    for (; i < n; i++) r = pick<Max>(r, a[i]);
+    return r;
+}
+
+template <bool Max>
+double scalarMinMaxFloat(const double* a, size_t n) {
+    if (n == 0) return 0;
+    if (n < 4) return finishMinMax<Max>(a[0], a, 1, n);
+    double l0 = a[0], l1 = a[1], l2 = a[2], l3 = a[3];
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        l0 = pick<Max>(l0, a[i]);
+        l1 = pick<Max>(l1, a[i + 1]);
+        l2 = pick<Max>(l2, a[i + 2]);
+        l3 = pick<Max>(l3, a[i + 3]);
+    }
+    return finishMinMax<Max>(pick<Max>(pick<Max>(l0, l2), pick<Max>(l1, l3)), a, i, n);
+}
+
+#if CZPP_SIMD_X86
+
+// ---- SSE2: 2 prvky v registru ----
+
+template <BinOp O>
+inline __m128d sseOp(__m128d x, __m128d y) {
+    if constexpr (O == BinOp::Add) return _mm_add_pd(x, y);
+    else if constexpr (O == BinOp::Sub) return _mm_sub_pd(x, y);
+    else if constexpr (O == BinOp::Mul) return _mm_mul_pd(x, y);
+    else return _mm_div_pd(x, y);
+}
+
+template <BinOp O, Shape S>
+void sseBinaryFloat(double* d, const double* a, const double* b, size_t n) {
+    __m128d sa = S == ScalarArr ? _mm_set1_pd(a[0]) : _mm_setzero_pd();
+    __m128d sb = S == ArrScalar ? _mm_set1_pd(b[0]) : _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = S == ScalarArr ? sa : _mm_loadu_pd(a + i);
+        __m128d y = S == ArrScalar ? sb : _mm_loadu_pd(b + i);
+        _mm_storeu_pd(d + i, sseOp<O>(x, y));
+    }
+    tail<double, O, S>(d, a, b, i, n);
+}
+
+// jen Add a Sub, nasobeni a deleni 64bitovych cisel SSE2 ani AVX2 neumi
+template <BinOp O, Shape S>
+void sseBinaryInt(long long* d, const long long* a, const long long* b, size_t n) {
+    __m128i sa = S == ScalarArr ? _mm_set1_epi64x(a[0]) : _mm_setzero_si128();
+    __m128i sb = S == ArrScalar ? _mm_set1_epi64x(b[0]) : _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i x = S == ScalarArr ? sa : _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = S == ArrScalar ? sb : _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i r = O == BinOp::Add ? _mm_add_epi64(x, y) : _mm_sub_epi64(x, y);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), r);
+    }
+    tail<long long, O, S>(d, a, b, i, n);
+}
+
+long long sseSumInt(const long long* a, size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) acc = _mm_add_epi64(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+    long long lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    long long s = wrapAdd(lanes[0], lanes[1]);
+    for (; i < n; i++) s = wrapAdd(s, a[i]);
+    return s;
+}
+
+// drahy 0,1 v lo a 2,3 v hi
+double sseSumFloat(const double* a, size_t n) {
+    __m128d lo = _mm_setzero_pd(), hi = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        lo = _mm_add_pd(lo, _mm_loadu_pd(a + i));
+        hi = _mm_add_pd(hi, _mm_loadu_pd(a + i + 2));
+    }
+    __m128d s = _mm_add_pd(lo, hi);
+    double r = _mm_cvtsd_f64(s) + _mm_cvtsd_f64(_mm_unpackhi_pd(s, s));
+    for (; i < n; i++) r += a[i];
+    return r;
+}
+
+// minpd/maxpd(x, acc) vraci x < acc ? x : acc (x > acc ? x : acc), jako pick
+template <bool Max>
+inline __m128d ssePick(__m128d acc, __m128d x) { return Max ? _mm_max_pd(x, acc) : _mm_min_pd(x, acc); }
+
+template <bool Max>
+double sseMinMaxFloat(const double* a, size_t n) {
+    if (n < 4) return scalarMinMaxFloat<Max>(a, n);
+    __m128d lo = _mm_loadu_pd(a), hi = _mm_loadu_pd(a + 2);
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        lo = ssePick<Max>(lo, _mm_loadu_pd(a + i));
+        hi = ssePick<Max>(hi, _mm_loadu_pd(a + i + 2));
+    }
+    __m128d m = ssePick<Max>(lo, hi);
+    return finishMinMax<Max>(pick<Max>(_mm_cvtsd_f64(m), _mm_cvtsd_f64(_mm_unpackhi_pd(m, m))), a, i, n);
+}
+
+// ---- AVX2: 4 prvky v registru ----
+
+template <BinOp O>
+CZPP_AVX2 inline __m256d avxOp(__m256d x, __m256d y) {
+    if constexpr (O == BinOp::Add) return _mm256_add_pd(x, y);
+    else if constexpr (O == BinOp::Sub) return _mm256_sub_pd(x, y);
+    else if constexpr (O == BinOp::Mul) return _mm256_mul_pd(x, y);
+    else return _mm256_div_pd(x, y);
+}
+
+template <BinOp O, Shape S>
+CZPP_AVX2 void avxBinaryFloat(double* d, const double* a, const double* b, size_t n) {
+    __m256d sa = S == ScalarArr ? _mm256_set1_pd(a[0]) : _mm256_setzero_pd();
+    __m256d sb = S == ArrScalar ? _mm256_set1_pd(b[0]) : _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = S == ScalarArr ? sa : _mm256_loadu_pd(a + i);
+        __m256d y = S == ArrScalar ? sb : _mm256_loadu_pd(b + i);
+        _mm256_storeu_pd(d + i, avxOp<O>(x, y));
+    }
+    tail<double, O, S>(d, a, b, i, n);
+}
+
+template <BinOp O, Shape S>
+CZPP_AVX2 void avxBinaryInt(long long* d, const long long* a, const long long* b, size_t n) {
+    __m256i sa = S == ScalarArr ? _mm256_set1_epi64x(a[0]) : _mm256_setzero_si256();
+    __m256i sb = S == ArrScalar ? _mm256_set1_epi64x(b[0]) : _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = S == ScalarArr ? sa : _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = S == ArrScalar ? sb : _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i r = O == BinOp::Add ? _mm256_add_epi64(x, y) : _mm256_sub_epi64(x, y);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), r);
+    }
+    tail<long long, O, S>(d, a, b, i, n);
+}
+
+CZPP_AVX2 long long avxSumInt(const long long* a, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) acc = _mm256_add_epi64(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+    long long lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    long long s = wrapAdd(wrapAdd(lanes[0], lanes[1]), wrapAdd(lanes[2], lanes[3]));
+    for (; i < n; i++) s = wrapAdd(s, a[i]);
+    return s;
+}
+
+template <bool Max>
+CZPP_AVX2 long long avxMinMaxInt(const long long* a, size_t n) {
+    if (n < 4) return scalarMinMaxInt<Max>(a, n);
+    __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i take = Max ? _mm256_cmpgt_epi64(x, acc) : _mm256_cmpgt_epi64(acc, x);
+        acc = _mm256_blendv_epi8(acc, x, take);
+    }
+    long long lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    long long r = lanes[0];
+    for (int k = 1; k < 4; k++) r = (Max ? lanes[k] > r : lanes[k] < r) ? lanes[k] : r;
+    for (; i < n; i++) r = (Max ? a[i] > r : a[i] < r) ? a[i] : r;
+    return r;
+}
+
+CZPP_AVX2 double avxSumFloat(const double* a, size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) acc = _mm256_add_pd(acc, _mm256_loadu_pd(a + i));
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    double r = _mm_cvtsd_f64(s) + _mm_cvtsd_f64(_mm_unpackhi_pd(s, s));
+    for (; i < n; i++) r += a[i];
+    return r;
+}
+
+template <bool Max>
+CZPP_AVX2 double avxMinMaxFloat(const double* a, size_t n) {
+    if (n < 4) return scalarMinMaxFloat<Max>(a, n);
+    __m256d acc = _mm256_loadu_pd(a);
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i);
+        acc = Max ? _mm256_max_pd(x, acc) : _mm256_min_pd(x, acc);
+    }
+    __m128d m = ssePick<Max>(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    return finishMinMax<Max>(pick<Max>(_mm_cvtsd_f64(m), _mm_cvtsd_f64(_mm_unpackhi_pd(m, m))), a, i, n);
+}
+
+#endif // CZPP_SIMD_X86
+
+using BinaryIntFn = void (*)(long long*, const long long*, const long long*, size_t);
+using BinaryFloatFn = void (*)(double*, const double*, const double*, size_t);
+
+// Tabulka jedne urovne; binary* jsou indexovane [BinOp][Shape].
+struct Kernels {
+    BinaryIntFn binaryInt[4][3];
+    BinaryFloatFn binaryFloat[4][3];
+    long long (*reduceInt[3])(const long long*, size_t);
+    double (*reduceFloat[3])(const double*, size_t);
+};
+
+#define CZPP_SHAPES(fn, O) { fn<BinOp::O, ArrArr>, fn<BinOp::O, ArrScalar>, fn<BinOp::O, ScalarArr> }
+#define CZPP_ARITH(fn) { CZPP_SHAPES(fn, Add), CZPP_SHAPES(fn, Sub), CZPP_SHAPES(fn, Mul), CZPP_SHAPES(fn, Div) }
+// cele_cislo: vektorove jen scitani a odcitani
+#define CZPP_ARITH_INT(fn) { CZPP_SHAPES(fn, Add), CZPP_SHAPES(fn, Sub), \
+    CZPP_SHAPES(scalarBinaryInt, Mul), CZPP_SHAPES(scalarBinaryInt, Div) }
+
+constexpr Kernels scalarKernels = {
+    CZPP_ARITH(scalarBinaryInt),
+    CZPP_ARITH(scalarBinaryFloat),
+    { scalarSumInt, scalarMinMaxInt<false>, scalarMinMaxInt<true> },
+    { scalarSumFloat, scalarMinMaxFloat<false>, scalarMinMaxFloat<true> },
+};
+
+#if CZPP_SIMD_X86
+constexpr Kernels sse2Kernels = {
+    CZPP_ARITH_INT(sseBinaryInt),
+    CZPP_ARITH(sseBinaryFloat),
+    { sseSumInt, scalarMinMaxInt<false>, scalarMinMaxInt<true> },
+    { sseSumFloat, sseMinMaxFloat<false>, sseMinMaxFloat<true> },
+};
+
+constexpr Kernels avx2Kernels = {
+    CZPP_ARITH_INT(avxBinaryInt),
+    CZPP_ARITH(avxBinaryFloat),
+    { avxSumInt, avxMinMaxInt<false>, avxMinMaxInt<true> },
+    { avxSumFloat, avxMinMaxFloat<false>, avxMinMaxFloat<true> },
+};
+#endif
+
+#undef CZPP_ARITH_INT
+#undef CZPP_ARITH
+#undef CZPP_SHAPES
+
+Level detect() {
+    Level best = Level::Scalar;
+#if CZPP_SIMD_X86
+    best = Level::Sse2;
+#ifdef _MSC_VER
+    // AVX2 (CPUID 7, EBX bit 5) a operacni system, ktery uklada registry YMM
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] >= 7) {
+        __cpuid(r, 1);
+        bool osAvx = (r[2] & (1 << 27)) && (r[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(r, 7, 0);
+        if (osAvx && (r[1] & (1 << 5))) best = Level::Avx2;
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) best = Level::Avx2;
+#endif
+#endif
+    // CZPP_SIMD smi uroven jen snizit
+    if (const char* env = std::getenv("CZPP_SIMD")) {
+        Level want = !std::strcmp(env, "scalar") ? Level::Scalar : !std::strcmp(env, "sse2") ? Level::Sse2 : Level::Avx2;
+        if (want < best) best = want;
+    }
+    return best;
+}
+
+const Kernels& kernels() {
+    static const Kernels* const k = [] {
+#if CZPP_SIMD_X86
+        if (level() == Level::Avx2) return &avx2Kernels;
+        if (level() == Level::Sse2) return &sse2Kernels;
+#endif
+        return &scalarKernels;
+    }();
+    return *k;
+}
+
+} // namespace
+
+Level level() {
+    static const Level l = detect();
+    return l;
+}
+
+const char* levelName(Level l) {
+    switch (l) {
+    case Level::Avx2: return "avx2";
+    case Level::Sse2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+void binaryInt(BinOp op, Shape shape, long long* dst, const long long* a, const long long* b, size_t n) {
+    kernels().binaryInt[(size_t)op][shape](dst, a, b, n);
+}
+
+void binaryFloat(BinOp op, Shape shape, double* dst, const double* a, const double* b, size_t n) {
+    kernels().binaryFloat[(size_t)op][shape](dst, a, b, n);
+}
+
+long long reduceInt(Reduce r, const long long* a, size_t n) {
+    return kernels().reduceInt[(size_t)r](a, n);
+}
+
+double reduceFloat(Reduce r, const double* a, size_t n) {
+    return kernels().reduceFloat[(size_t)r](a, n);
+}
+
+} // namespace simd
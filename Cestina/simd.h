@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "arith.h"
+
+// Kernely pro operace nad poli (pole cele_cislo / pole plout). Implementace
+// se vybere jednou, pri prvnim pouziti, podle procesoru: AVX2, SSE2, nebo
+// obycejne smycky. Promenna prostredi CZPP_SIMD=scalar|sse2|avx2 vyber
+// omezi (srovnani vystupu, mereni). Vysledky jsou na vsech urovnich bit
+// po bitu stejne, viz reduceFloat.
+namespace simd {
+
+enum class Level : uint8_t { Scalar, Sse2, Avx2 };
+Level level();
+const char* levelName(Level l);
+
+// Ktery operand je skalar rozsireny na celou delku.
+enum Shape : uint8_t { ArrArr, ArrScalar, ScalarArr };
+
+// dst[i] = a[i] op b[i] pro i < n, op je Add, Sub, Mul nebo Div. U ArrScalar
+// ukazuje b na jediny prvek, u ScalarArr a. dst muze byt totozne s a nebo b.
+// cele_cislo ma stejnou semantiku jako skalarni VM (wrapAdd .. intDiv).
+void binaryInt(BinOp op, Shape shape, long long* dst, const long long* a, const long long* b, size_t n);
+void binaryFloat(BinOp op, Shape shape, double* dst, const double* a, const double* b, size_t n);
+
+// soucet, minimum a maximum; prazdne pole dava 0
+enum class Reduce : uint8_t { Sum, Min, Max };
+long long reduceInt(Reduce r, const long long* a, size_t n);
+// Plout se scita ve 4 drahach (prvek i do drahy i % 4), drahy se slozi jako
+// (d0 + d2) + (d1 + d3) a zbytek se pricte postupne. Poradi tak nezavisi na
+// sirce registru. Minimum a maximum berou x < acc ? x : acc ve stejnem poradi.
+double reduceFloat(Reduce r, const double* a, size_t n);
+
+} // namespace simd
@@ -0,0 +1,60 @@
+#include "source.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool SourceFile::open(const std::string& path, std::string& err) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { err = "Nelze otevrit soubor: " + path; return false; }
+    LARGE_INTEGER len;
+    bool ok = GetFileSizeEx(file, &len) != 0;
+    // prazdny soubor namapovat nejde, staci prazdny pohled
+    if (ok && len.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping) CloseHandle(mapping);
+        ok = view != nullptr;
+        data = (const char*)view;
+        size = ok ? (size_t)len.QuadPart : 0;
+    }
+    CloseHandle(file);
+    if (!ok) err = "Nelze nacist soubor: " + path;
+    return ok;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { err = "Nelze otevrit soubor: " + path; return false; }
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    if (ok && st.st_size > 0) {
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ok = p != MAP_FAILED;
+        if (ok) {
+            madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL); // lexer cte jednou od zacatku
+            data = (const char*)p;
+            size = (size_t)st.st_size;
+        }
+    }
+    ::close(fd);
+    if (!ok) err = "Nelze nacist soubor: " + path;
+    return ok;
+#endif
+}
+
+void SourceFile::close() {
+    if (!data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap((void*)data, size);
+#endif
+    data = nullptr;
+    size = 0;
+}
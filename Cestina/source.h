@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Zdrojovy soubor namapovany do pameti jen pro cteni. Interpret dostane
+// string_view primo nad mapovanim, nic se nekopiruje; tokeny i chybove
+// hlasky odkazuji do nej, objekt proto musi zit do konce behu.
+class SourceFile {
+public:
+    SourceFile() = default;
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+    ~SourceFile() { close(); }
+
+    // pri chybe vrati false a do err da hlasku
+    bool open(const std::string& path, std::string& err);
+    void close();
+    std::string_view text() const { return { data, size }; }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+};
@@ -0,0 +1,543 @@
+#include "transpile.h"
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+
+// Runtime vlozeny na zacatek kazdeho vygenerovaneho programu. Funkce odpovidaji
+// arith.h (wrapAdd .. intDiv), Value::format, OutputSink a kernelum simd.
+static const char* const Runtime = R"(// Vygenerovano prikazem czpp compile, neupravovat.
+#include <charconv>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rt {
+
+using IArr = std::vector<long long>;
+using FArr = std::vector<double>;
+
+inline long long wadd(long long a, long long b) { return (long long)((unsigned long long)a + (unsigned long long)b); }
+inline long long wsub(long long a, long long b) { return (long long)((unsigned long long)a - (unsigned long long)b); }
+inline long long wmul(long long a, long long b) { return (long long)((unsigned long long)a * (unsigned long long)b); }
+inline long long idiv(long long a, long long b) { return b == 0 ? 0 : b == -1 ? wsub(0, a) : a / b; }
+inline double fadd(double a, double b) { return a + b; }
+inline double fsub(double a, double b) { return a - b; }
+inline double fmul(double a, double b) { return a * b; }
+inline double fdiv(double a, double b) { return a / b; }
+
+// jako (long long)x ve VM; na x86-64 dava NaN a cisla mimo rozsah LLONG_MIN
+inline long long f2i(double x) {
+#if defined(__x86_64__) || defined(_M_X64)
+    if (!(x >= -9223372036854775808.0 && x < 9223372036854775808.0)) return LLONG_MIN;
+#endif
+    return (long long)x;
+}
+
+struct Out {
+    char buf[8192];
+    size_t len = 0;
+    void write(const char* s, size_t n) {
+        if (n > sizeof buf - len) {
+            flush();
+            if (n >= sizeof buf) { std::fwrite(s, 1, n, stdout); return; }
+        }
+        std::memcpy(buf + len, s, n);
+        len += n;
+    }
+    void flush() {
+        std::fwrite(buf, 1, len, stdout);
+        std::fflush(stdout);
+        len = 0;
+    }
+};
+static Out out;
+
+inline void put(std::string_view s) { out.write(s.data(), s.size()); }
+inline void fmt(long long x) {
+    char b[32];
+    auto r = std::to_chars(b, b + sizeof b, x);
+    out.write(b, (size_t)(r.ptr - b));
+}
+inline void fmt(double x) {
+    char b[32];
+    auto r = std::to_chars(b, b + sizeof b, x, std::chars_format::general, 6);
+    out.write(b, (size_t)(r.ptr - b));
+}
+inline void fmt(bool x) { put(x ? "pravda" : "nepravda"); }
+inline void fmt(std::string_view s) { put(s); }
+template <class T>
+void fmt(const std::vector<T>& a) {
+    put("[");
+    for (size_t k = 0; k < a.size(); k++) {
+        if (k) put(", ");
+        fmt(a[k]);
+    }
+    put("]");
+}
+// slovnik: polozky v poradi vkladani jako DictObj, klic cele_cislo nebo retezec
+struct Key {
+    bool str;
+    long long i;
+    std::string_view s;
+    bool operator==(const Key& o) const { return str == o.str && (str ? s == o.s : i == o.i); }
+};
+struct KeyHash {
+    size_t operator()(const Key& k) const { return k.str ? std::hash<std::string_view>()(k.s) : std::hash<long long>()(k.i); }
+};
+inline Key key(long long i) { return { false, i, {} }; }
+inline Key key(std::string_view s) { return { true, 0, s }; }
+template <class T>
+struct Dict {
+    std::vector<std::pair<Key, T>> items;
+    std::unordered_map<Key, size_t, KeyHash> index;
+    size_t size() const { return items.size(); }
+};
+template <class T>
+void fmt(const Dict<T>& d) {
+    put("{");
+    for (size_t k = 0; k < d.items.size(); k++) {
+        const Key& key = d.items[k].first;
+        if (k) put(", ");
+        if (key.str) {
+            put("\"");
+            put(key.s);
+            put("\"");
+        }
+        else fmt(key.i);
+        put(": ");
+        fmt(d.items[k].second);
+    }
+    put("}");
+}
+template <class T>
+void print(const T& v) {
+    fmt(v);
+    put("            ");
+}
+
+// pole: index mimo rozsah cte 0 a zapis ignoruje
+template <class T>
+std::vector<T> make(long long n) { return std::vector<T>(n > 0 ? (size_t)n : 0); }
+template <class T>
+T at(const std::vector<T>& a, long long i) { return (unsigned long long)i < a.size() ? a[(size_t)i] : 0; }
+template <class T>
+void set(std::vector<T>& a, long long i, T v) { if ((unsigned long long)i < a.size()) a[(size_t)i] = v; }
+// slovnik: chybejici klic cte 0, zapis ho prida; rezerva jako slovnik d[n]
+template <class T>
+Dict<T> makeDict(long long n) {
+    Dict<T> d;
+    if (n > 0) {
+        d.items.reserve((size_t)n);
+        d.index.reserve((size_t)n);
+    }
+    return d;
+}
+template <class T, class K>
+T at(const Dict<T>& d, K k) {
+    auto it = d.index.find(key(k));
+    return it == d.index.end() ? 0 : d.items[it->second].second;
+}
+template <class T, class K>
+void set(Dict<T>& d, K k, T v) {
+    auto [it, fresh] = d.index.try_emplace(key(k), d.items.size());
+    if (fresh) d.items.push_back({ key(k), v });
+    else d.items[it->second].second = v;
+}
+template <class T, class K>
+bool has(const Dict<T>& d, K k) { return d.index.count(key(k)) != 0; }
+inline FArr toF(const IArr& a) {
+    FArr r(a.size());
+    for (size_t k = 0; k < a.size(); k++) r[k] = (double)a[k];
+    return r;
+}
+inline IArr toI(const FArr& a) {
+    IArr r(a.size());
+    for (size_t k = 0; k < a.size(); k++) r[k] = f2i(a[k]);
+    return r;
+}
+// prvni pole se predava hodnotou, docasny mezivysledek se tak prepise na
+// miste stejne jako pole s refs == 1 ve VM
+template <auto f, class T>
+std::vector<T> zip(std::vector<T> a, const std::vector<T>& b) {
+    if (b.size() < a.size()) a.resize(b.size());
+    for (size_t k = 0; k < a.size(); k++) a[k] = f(a[k], b[k]);
+    return a;
+}
+template <auto f, class T>
+std::vector<T> zip(std::vector<T> a, T s) {
+    for (size_t k = 0; k < a.size(); k++) a[k] = f(a[k], s);
+    return a;
+}
+template <auto f, class T>
+std::vector<T> zip(T s, std::vector<T> b) {
+    for (size_t k = 0; k < b.size(); k++) b[k] = f(s, b[k]);
+    return b;
+}
+
+inline long long sum(const IArr& a) {
+    long long s = 0;
+    for (long long x : a) s = wadd(s, x);
+    return s;
+}
+template <bool Max>
+long long minmax(const IArr& a) {
+    if (a.empty()) return 0;
+    long long r = a[0];
+    for (long long x : a) r = (Max ? x > r : x < r) ? x : r;
+    return r;
+}
+// 4 drahy slozene jako (d0 + d2) + (d1 + d3), viz simd::reduceFloat
+inline double sum(const FArr& a) {
+    double l0 = 0, l1 = 0, l2 = 0, l3 = 0;
+    size_t n = a.size(), i = 0;
+    for (; i + 4 <= n; i += 4) {
+        l0 += a[i];
+        l1 += a[i + 1];
+        l2 += a[i + 2];
+        l3 += a[i + 3];
+    }
+    double s = (l0 + l2) + (l1 + l3);
+    for (; i < n; i++) s += a[i];
+    return s;
+}
+template <bool Max>
+inline double pick(double acc, double x) { return (Max ? x > acc : x < acc) ? x : acc; }
+template <bool Max>
+double minmax(const FArr& a) {
+    size_t n = a.size(), i = 4;
+    if (n == 0) return 0;
+    double r;
+    if (n < 4) {
+        r = a[0];
+        i = 1;
+    }
+    else {
+        double l0 = a[0], l1 = a[1], l2 = a[2], l3 = a[3];
+        for (; i + 4 <= n; i += 4) {
+            l0 = pick<Max>(l0, a[i]);
+            l1 = pick<Max>(l1, a[i + 1]);
+            l2 = pick<Max>(l2, a[i + 2]);
+            l3 = pick<Max>(l3, a[i + 3]);
+        }
+        r = pick<Max>(pick<Max>(l0, l2), pick<Max>(l1, l3));
+    }
+    for (; i < n; i++) r = pick<Max>(r, a[i]);
+    return r;
+}
+
+} // namespace rt
+)";
+
+static bool isArray(Value::Type t) { return t == Value::ARRAY_INT || t == Value::ARRAY_FLOAT; }
+static bool isDict(Value::Type t) { return t == Value::DICT_INT || t == Value::DICT_FLOAT; }
+
+static const char* cppType(Value::Type t) {
+    switch (t) {
+    case Value::INT: return "long long";
+    case Value::FLOAT: return "double";
+    case Value::BOOL: return "bool";
+    case Value::ARRAY_INT: return "rt::IArr";
+    case Value::ARRAY_FLOAT: return "rt::FArr";
+    case Value::DICT_INT: return "rt::Dict<long long>";
+    case Value::DICT_FLOAT: return "rt::Dict<double>";
+    default: return "std::string_view";
+    }
+}
+
+static const char* cppElem(Value::Type t) { return t == Value::ARRAY_FLOAT || t == Value::DICT_FLOAT ? "double" : "long long"; }
+
+// spojeni kousku kodu; GCC 12 u "literal" + std::string hlasi falesne -Wrestrict
+template <class... Parts>
+static std::string cat(const Parts&... parts) {
+    std::string s;
+    (s += ... += parts);
+    return s;
+}
+
+static std::string var(int32_t slot) { return cat("v", std::to_string(slot)); }
+
+// Literal tak, aby ho prekladac C++ nacetl na stejnou hodnotu: plout jako
+// hexadecimalni literal (presny), retezce s osmickovymi escape sekvencemi.
+static std::string literal(const Value& v) {
+    switch (v.type) {
+    case Value::INT:
+        if (v.i == LLONG_MIN) return "(-9223372036854775807LL - 1)";
+        return v.i < 0 ? cat("(", std::to_string(v.i), "LL)") : cat(std::to_string(v.i), "LL");
+    case Value::FLOAT: {
+        const char* sign = std::signbit(v.f) ? "(-" : "(";
+        if (std::isnan(v.f)) return cat(sign, "std::numeric_limits<double>::quiet_NaN())");
+        if (std::isinf(v.f)) return cat(sign, "std::numeric_limits<double>::infinity())");
+        char buf[64];
+        auto r = std::to_chars(buf, buf + sizeof buf, std::fabs(v.f), std::chars_format::hex);
+        return cat(sign, "0x", std::string_view(buf, (size_t)(r.ptr - buf)), ")");
+    }
+    case Value::BOOL:
+        return v.b ? "true" : "false";
+    case Value::STRING: {
+        std::string s = "std::string_view(\"";
+        for (unsigned char c : v.str()) {
+            if (c >= 0x20 && c < 0x7F && c != '"' && c != '\\' && c != '?') s += (char)c;
+            else {
+                char esc[8];
+                std::snprintf(esc, sizeof esc, "\\%03o", c);
+                s += esc;
+            }
+        }
+        return cat(s, "\", ", std::to_string(v.str().size()), ")");
+    }
+    default:
+        return "0";
+    }
+}
+
+// prevod mezi cele_cislo a plout (i u poli), jako Compiler::convert
+static std::string convert(const std::string& code, Value::Type from, Value::Type to) {
+    if (from == Value::INT && to == Value::FLOAT) return cat("(double)(", code, ")");
+    if (from == Value::FLOAT && to == Value::INT) return cat("rt::f2i(", code, ")");
+    if (from == Value::ARRAY_INT && to == Value::ARRAY_FLOAT) return cat("rt::toF(", code, ")");
+    if (from == Value::ARRAY_FLOAT && to == Value::ARRAY_INT) return cat("rt::toI(", code, ")");
+    return code;
+}
+
+static const char* arithFn(BinOp op, bool f) {
+    switch (op) {
+    case BinOp::Add: return f ? "rt::fadd" : "rt::wadd";
+    case BinOp::Sub: return f ? "rt::fsub" : "rt::wsub";
+    case BinOp::Mul: return f ? "rt::fmul" : "rt::wmul";
+    default: return f ? "rt::fdiv" : "rt::idiv";
+    }
+}
+
+static const char* cmpOp(BinOp op) {
+    switch (op) {
+    case BinOp::Lt: return " < ";
+    case BinOp::Le: return " <= ";
+    case BinOp::Gt: return " > ";
+    case BinOp::Ge: return " >= ";
+    case BinOp::Eq: return " == ";
+    default: return " != ";
+    }
+}
+
+static std::string funcName(const FuncDef& f) { return cat("f", std::to_string(f.index)); }
+
+// hlavicka funkce skriptu; parametry jsou jeji prvni sloty
+static std::string signature(const FuncDef& f) {
+    std::string s = cat("static ", f.ret == Value::NONE ? "void" : cppType(f.ret), " ", funcName(f), "(");
+    for (size_t k = 0; k < f.params.size(); k++)
+        s += cat(k ? ", " : "", cppType(f.params[k].type), " ", var((int32_t)k));
+    return cat(s, ")");
+}
+
+// nulova hodnota typu, jako Compiler::pushDefault
+static std::string zero(Value::Type t) {
+    if (isArray(t)) return cat("rt::make<", cppElem(t), ">(0)");
+    if (isDict(t)) return cat(cppType(t), "()");
+    return t == Value::FLOAT ? "0.0" : t == Value::BOOL ? "false" : "0";
+}
+
+std::string Transpiler::transpile(const Block& program, const std::vector<SlotInfo>& slotInfo) {
+    out = Runtime;
+    indent = 0;
+    // funkce skriptu se mohou volat navzajem v libovolnem poradi
+    for (const StmtPtr& s : program.stmts)
+        if (s->kind == Stmt::Func) line(cat(signature(*s->func), "; // ", s->func->name));
+    for (const StmtPtr& s : program.stmts)
+        if (s->kind == Stmt::Func) function(*s->func);
+    out += "\nint main() {\n";
+    slots = &slotInfo;
+    indent = 1;
+    // kazdy slot je jedna promenna main; deklarace v programu ji jen prepise
+    for (size_t k = 0; k < slotInfo.size(); k++) {
+        const SlotInfo& si = slotInfo[k];
+        line(cat(cppType(si.type), " ", var((int32_t)k), "{}; // ", si.name));
+    }
+    block(program);
+    line("rt::out.flush();");
+    line("return 0;");
+    out += "}\n";
+    return std::move(out);
+}
+
+static bool selfTailCall(const Block& b, const FuncDef& f) {
+    for (const StmtPtr& s : b.stmts) {
+        const Expr* e = s->expr;
+        if (s->kind == Stmt::Return && e && e->kind == Expr::Call && e->fn == Builtin::User && e->func == &f) return true;
+        if (selfTailCall(s->body, f) || selfTailCall(s->elseBody, f)) return true;
+    }
+    return false;
+}
+
+// Lokalni promenne funkce jako u main. Koncove volani sebe sama se prepise
+// na skok na zacatek (konstantni zasobnik jako TAILCALL ve VM), ostatni
+// koncova volani nechava na optimalizaci prekladace C++.
+void Transpiler::function(const FuncDef& f) {
+    fn = &f;
+    slots = &f.slots;
+    out += '\n';
+    line(cat(signature(f), " {"));
+    indent = 1;
+    if (selfTailCall(f.body, f)) line("top:");
+    for (size_t k = f.params.size(); k < f.slots.size(); k++) {
+        const SlotInfo& si = f.slots[k];
+        line(cat(cppType(si.type), " ", var((int32_t)k), "{}; // ", si.name));
+    }
+    block(f.body);
+    if (f.ret != Value::NONE) line(cat("return ", zero(f.ret), ";"));
+    indent = 0;
+    line("}");
+    fn = nullptr;
+}
+
+void Transpiler::line(const std::string& code) {
+    out.append((size_t)indent * 4, ' ');
+    out += code;
+    out += '\n';
+}
+
+std::string Transpiler::expr(const Expr& e) {
+    switch (e.kind) {
+    case Expr::Literal:
+        return literal(e.value);
+    case Expr::Var:
+        return var(e.slot);
+    case Expr::Binary: {
+        if (isArray(e.type)) return arrayBinary(e);
+        Value::Type l = e.lhs->type, r = e.rhs->type;
+        Value::Type t = l == Value::FLOAT || r == Value::FLOAT ? Value::FLOAT : l;
+        std::string a = convert(expr(*e.lhs), l, t), b = convert(expr(*e.rhs), r, t);
+        if (isComparison(e.op)) return cat("(", a, cmpOp(e.op), b, ")");
+        return cat(arithFn(e.op, t == Value::FLOAT), "(", a, ", ", b, ")");
+    }
+    case Expr::Index:
+        return cat("rt::at(", expr(*e.lhs), ", ", expr(*e.rhs), ")");
+    case Expr::Call: {
+        if (e.fn == Builtin::User) return cat(funcName(*e.func), "(", args(e), ")");
+        std::string a = expr(*e.lhs);
+        switch (e.fn) {
+        case Builtin::Soucet: return cat("rt::sum(", a, ")");
+        case Builtin::Minimum: return cat("rt::minmax<false>(", a, ")");
+        case Builtin::Maximum: return cat("rt::minmax<true>(", a, ")");
+        case Builtin::Obsahuje: return cat("rt::has(", a, ", ", expr(*e.rhs), ")");
+        default: return cat("(long long)(", a, ").size()");
+        }
+    }
+    }
+    return "0";
+}
+
+// argumenty volani prevedene na typy parametru
+std::string Transpiler::args(const Expr& call) {
+    std::string s;
+    for (size_t k = 0; k < call.args.size(); k++)
+        s += cat(k ? ", " : "", convert(expr(*call.args[k]), call.args[k]->type, call.func->params[k].type));
+    return s;
+}
+
+// po prvcich, skalar se rozsiri; plout operand prevede druhy na plout
+std::string Transpiler::arrayBinary(const Expr& e) {
+    Value::Type l = e.lhs->type, r = e.rhs->type;
+    bool f = e.type == Value::ARRAY_FLOAT;
+    std::string a = expr(*e.lhs), b = expr(*e.rhs);
+    if (f) {
+        a = convert(a, l, isArray(l) ? Value::ARRAY_FLOAT : Value::FLOAT);
+        b = convert(b, r, isArray(r) ? Value::ARRAY_FLOAT : Value::FLOAT);
+    }
+    return cat("rt::zip<", arithFn(e.op, f), ">(", a, ", ", b, ")");
+}
+
+// pravdivost jako truthy(): retezce, pole a slovniky jsou vzdy nepravdive
+std::string Transpiler::cond(const Expr& e) {
+    switch (e.type) {
+    case Value::INT: return cat("(", expr(e), ") != 0");
+    case Value::FLOAT: return cat("(", expr(e), ") != 0.0");
+    case Value::BOOL: return expr(e);
+    default: return "false";
+    }
+}
+
+void Transpiler::block(const Block& b) {
+    for (const StmtPtr& s : b.stmts) stmt(*s);
+}
+
+void Transpiler::stmt(const Stmt& s) {
+    switch (s.kind) {
+    case Stmt::Decl: {
+        std::string init;
+        if (s.expr) init = convert(expr(*s.expr), s.expr->type, s.declType);
+        else if (isArray(s.declType))
+            init = cat("rt::make<", cppElem(s.declType), ">(", s.index ? expr(*s.index) : "0", ")");
+        else if (isDict(s.declType))
+            init = cat("rt::makeDict<", cppElem(s.declType), ">(", s.index ? expr(*s.index) : "0", ")");
+        else init = s.declType == Value::FLOAT ? "0.0" : s.declType == Value::BOOL ? "false" : "0";
+        line(cat(var(s.slot), " = ", init, ";"));
+        return;
+    }
+    case Stmt::Assign:
+        line(cat(var(s.slot), " = ", convert(expr(*s.expr), s.expr->type, (*slots)[s.slot].type), ";"));
+        return;
+    case Stmt::SetIndex: {
+        Value::Type t = (*slots)[s.slot].type;
+        Value::Type elem = t == Value::ARRAY_FLOAT || t == Value::DICT_FLOAT ? Value::FLOAT : Value::INT;
+        line(cat("rt::set(", var(s.slot), ", ", expr(*s.index), ", ", convert(expr(*s.expr), s.expr->type, elem), ");"));
+        return;
+    }
+    case Stmt::Print:
+        line(cat("rt::print(", expr(*s.expr), ");"));
+        return;
+    case Stmt::If:
+        line(cat("if (", cond(*s.expr), ") {"));
+        indent++;
+        block(s.body);
+        indent--;
+        if (s.hasElse) {
+            line("}");
+            line("else {");
+            indent++;
+            block(s.elseBody);
+            indent--;
+        }
+        line("}");
+        return;
+    case Stmt::While:
+        line(cat("while (", cond(*s.expr), ") {"));
+        indent++;
+        block(s.body);
+        indent--;
+        line("}");
+        return;
+    case Stmt::Return: {
+        const Expr* e = s.expr;
+        if (!e) {
+            line("return;");
+            return;
+        }
+        if (e->kind == Expr::Call && e->fn == Builtin::User && e->func == fn) {
+            // argumenty se vyhodnoti vsechny drive, nez se prepise prvni parametr
+            line("{");
+            indent++;
+            for (size_t k = 0; k < e->args.size(); k++)
+                line(cat("auto a", std::to_string(k), " = ", convert(expr(*e->args[k]), e->args[k]->type, fn->params[k].type), ";"));
+            for (size_t k = 0; k < e->args.size(); k++)
+                line(cat(var((int32_t)k), " = std::move(a", std::to_string(k), ");"));
+            indent--;
+            line("}");
+            line("goto top;");
+            return;
+        }
+        line(cat("return ", convert(expr(*e), e->type, fn->ret), ";"));
+        return;
+    }
+    case Stmt::Eval:
+        line(cat(expr(*s.expr), ";"));
+        return;
+    case Stmt::Func:
+        return;
+    }
+}
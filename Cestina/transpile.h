@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "ast.h"
+
+// Preklad AST do samostatneho C++ (czpp compile). Vystup je jeden soubor
+// s malym runtime na zacatku a funkci main, prelozitelny libovolnym
+// prekladacem C++17. Semantika je stejna jako ve VM: cele_cislo pretece
+// modulo 2^64, deleni nulou dava 0, smiseny cele_cislo/plout se pocita
+// v plout, plout se tiskne se 6 platnymi cislicemi a tiskni pise stejne
+// oddelovace. Pole se vraci jako std::vector, soucty plout pouzivaji
+// stejne poradi scitani jako kernely simd. Slovnik je std::unordered_map
+// nad polozkami v poradi vkladani, tiskne se tedy stejne jako ve VM. Funkce skriptu jsou staticke
+// funkce C++; hluboka rekurze bez koncoveho volani muze na rozdil od VM
+// vycerpat zasobnik procesu.
+class Transpiler {
+public:
+    // program uz musi projit Resolverem, ktery vratil slots, a TypeCheckerem
+    std::string transpile(const Block& program, const std::vector<SlotInfo>& slots);
+
+private:
+    const std::vector<SlotInfo>* slots = nullptr;
+    const FuncDef* fn = nullptr; // prave prekladana funkce
+    std::string out;
+    int indent = 1;
+
+    void function(const FuncDef& f);
+    std::string expr(const Expr& e);
+    std::string args(const Expr& call);
+    std::string arrayBinary(const Expr& e);
+    std::string cond(const Expr& e);
+    void block(const Block& b);
+    void stmt(const Stmt& s);
+    void line(const std::string& code);
+};
@@ -0,0 +1,175 @@
+#include "typecheck.h"
+
+void TypeChecker::check(Block& program, const std::vector<SlotInfo>& slotInfo) {
+    slots = &slotInfo;
+    checkBlock(program);
+}
+
+static bool numeric(Value::Type t) { return t == Value::INT || t == Value::FLOAT; }
+static bool isArray(Value::Type t) { return t == Value::ARRAY_INT || t == Value::ARRAY_FLOAT; }
+static bool isDict(Value::Type t) { return t == Value::DICT_INT || t == Value::DICT_FLOAT; }
+static bool isKey(Value::Type t) { return t == Value::INT || t == Value::STRING; }
+
+// Stejna pravidla jako coerce(): cele_cislo <-> plout, boolean jen z boolean.
+// Pole se prirazuji jen z pole, typ prvku se prevede stejne jako u cisel.
+// Slovnik jen ze slovniku stejneho typu (prevod by kopiroval celou tabulku).
+static bool assignable(Value::Type dest, Value::Type t) {
+    if (isArray(dest)) return isArray(t);
+    if (isDict(dest)) return dest == t;
+    return dest == Value::BOOL ? t == Value::BOOL : numeric(dest) && numeric(t);
+}
+
+static std::string arrayError(const char* what, const Expr& e) {
+    return std::string("Typova chyba: ") + what + nodePos(e.line, e.col);
+}
+
+Value::Type TypeChecker::checkExpr(Expr& e) {
+    switch (e.kind) {
+    case Expr::Literal:
+        e.type = e.value.type;
+        break;
+    case Expr::Var:
+        e.type = (*slots)[e.slot].type;
+        break;
+    case Expr::Binary: {
+        Value::Type l = checkExpr(*e.lhs);
+        Value::Type r = checkExpr(*e.rhs);
+        bool num = numeric(l) && numeric(r);
+        if (isComparison(e.op)) {
+            bool eq = e.op == BinOp::Eq || e.op == BinOp::Ne;
+            if (!num && !(eq && l == r && (l == Value::BOOL || l == Value::STRING)))
+                throw std::string("Typova chyba: nelze porovnat") + nodePos(e.line, e.col);
+            e.type = Value::BOOL;
+        }
+        else if (isArray(l) || isArray(r)) {
+            // po prvcich; skalar se rozsiri na celou delku pole
+            if (!(isArray(l) || numeric(l)) || !(isArray(r) || numeric(r)))
+                throw std::string("Typova chyba: aritmetika s nenumerickou hodnotou") + nodePos(e.line, e.col);
+            bool ints = (l == Value::INT || l == Value::ARRAY_INT) && (r == Value::INT || r == Value::ARRAY_INT);
+            e.type = ints ? Value::ARRAY_INT : Value::ARRAY_FLOAT;
+        }
+        else {
+            if (!num) throw std::string("Typova chyba: aritmetika s nenumerickou hodnotou") + nodePos(e.line, e.col);
+            e.type = l == Value::INT && r == Value::INT ? Value::INT : Value::FLOAT;
+        }
+        break;
+    }
+    case Expr::Index: {
+        Value::Type a = checkExpr(*e.lhs);
+        if (isDict(a)) {
+            if (!isKey(checkExpr(*e.rhs))) throw arrayError("klic slovniku musi byt cele_cislo nebo retezec", e);
+            e.type = a == Value::DICT_INT ? Value::INT : Value::FLOAT;
+            break;
+        }
+        if (!isArray(a)) throw arrayError("indexovat lze jen pole nebo slovnik", e);
+        if (checkExpr(*e.rhs) != Value::INT) throw arrayError("index pole musi byt cele_cislo", e);
+        e.type = a == Value::ARRAY_INT ? Value::INT : Value::FLOAT;
+        break;
+    }
+    case Expr::Call: {
+        if (e.fn == Builtin::User) {
+            if (checkCall(e) == Value::NONE)
+                throw std::string("Typova chyba: funkce ") + std::string(e.name) + " nevraci hodnotu" + nodePos(e.line, e.col);
+            break;
+        }
+        Value::Type a = checkExpr(*e.lhs);
+        if (e.fn == Builtin::Obsahuje) {
+            if (!isDict(a)) throw arrayError("prvni argument obsahuje musi byt slovnik", e);
+            if (!isKey(checkExpr(*e.rhs))) throw arrayError("klic slovniku musi byt cele_cislo nebo retezec", e);
+            e.type = Value::BOOL;
+            break;
+        }
+        if (e.fn == Builtin::Delka && isDict(a)) {
+            e.type = Value::INT;
+            break;
+        }
+        if (!isArray(a)) throw arrayError("argument funkce musi byt pole", e);
+        e.type = e.fn == Builtin::Delka || a == Value::ARRAY_INT ? Value::INT : Value::FLOAT;
+        break;
+    }
+    }
+    return e.type;
+}
+
+// Volani funkce skriptu; argumenty se prevadi na typy parametru jako pri
+// prirazeni. Vysledek NONE = funkce nevraci hodnotu.
+Value::Type TypeChecker::checkCall(Expr& e) {
+    const FuncDef& f = *e.func;
+    if (e.args.size() != f.params.size())
+        throw std::string("Spatny pocet argumentu funkce ") + std::string(e.name) + " (ocekavano " + std::to_string(f.params.size()) + ")" + nodePos(e.line, e.col);
+    for (size_t k = 0; k < e.args.size(); k++) {
+        Expr& a = *e.args[k];
+        if (!assignable(f.params[k].type, checkExpr(a)))
+            throw std::string("Typova chyba: argument ") + std::to_string(k + 1) + " funkce " + std::string(e.name) + nodePos(a.line, a.col);
+    }
+    e.type = f.ret;
+    return e.type;
+}
+
+void TypeChecker::checkFunction(FuncDef& f) {
+    const std::vector<SlotInfo>* outer = slots;
+    slots = &f.slots;
+    current = &f;
+    checkBlock(f.body);
+    current = nullptr;
+    slots = outer;
+}
+
+void TypeChecker::checkBlock(Block& block) {
+    for (StmtPtr& s : block.stmts) {
+        if (s->kind == Stmt::Func) {
+            checkFunction(*s->func);
+            continue;
+        }
+        if (s->kind == Stmt::Eval) {
+            if (s->expr->fn == Builtin::User) checkCall(*s->expr);
+            else checkExpr(*s->expr);
+            continue;
+        }
+        Value::Type t = s->expr ? checkExpr(*s->expr) : Value::NONE;
+        if (s->kind == Stmt::SetIndex && !isArray((*slots)[s->slot].type) && !isDict((*slots)[s->slot].type))
+            throw std::string("Typova chyba: indexovat lze jen pole nebo slovnik") + nodePos(s->line, s->col);
+        if (s->index) {
+            Value::Type i = checkExpr(*s->index);
+            // klic slovniku: cele_cislo nebo retezec, rezerva slovniku jako velikost pole
+            bool dict = s->kind == Stmt::SetIndex && isDict((*slots)[s->slot].type);
+            if (dict ? !isKey(i) : i != Value::INT)
+                throw std::string(dict ? "Typova chyba: klic slovniku musi byt cele_cislo nebo retezec"
+                    : s->kind != Stmt::Decl ? "Typova chyba: index pole musi byt cele_cislo"
+                    : isDict(s->declType) ? "Typova chyba: velikost slovniku musi byt cele_cislo"
+                    : "Typova chyba: velikost pole musi byt cele_cislo") + nodePos(s->line, s->col);
+        }
+        switch (s->kind) {
+        case Stmt::Decl:
+            if (s->expr && !assignable(s->declType, t)) {
+                const char* err = s->declType == Value::INT ? "Typova chyba pri prirazeni do cele_cislo"
+                    : s->declType == Value::FLOAT ? "Typova chyba pri prirazeni do plout"
+                    : s->declType == Value::BOOL ? "Typova chyba pri prirazeni do boolean"
+                    : isDict(s->declType) ? "Typova chyba pri prirazeni do slovniku"
+                    : "Typova chyba pri prirazeni do pole";
+                throw std::string(err) + nodePos(s->line, s->col);
+            }
+            break;
+        case Stmt::Assign: {
+            Value::Type dest = (*slots)[s->slot].type;
+            if (!assignable(dest, t))
+                throw std::string(dest == Value::BOOL ? "Typova chyba pri prirazeni boolean" : "Typova chyba pri prirazeni") + nodePos(s->line, s->col);
+            break;
+        }
+        case Stmt::SetIndex:
+            if (!numeric(t))
+                throw std::string(isDict((*slots)[s->slot].type) ? "Typova chyba pri prirazeni do slovniku"
+                    : "Typova chyba pri prirazeni do prvku pole") + nodePos(s->line, s->col);
+            break;
+        case Stmt::Return:
+            // bez hodnoty jen ve funkci bez typu, viz Parser
+            if (s->expr && !assignable(current->ret, t))
+                throw std::string("Typova chyba pri vraceni hodnoty z funkce ") + std::string(current->name) + nodePos(s->line, s->col);
+            break;
+        default:
+            break;
+        }
+        checkBlock(s->body);
+        checkBlock(s->elseBody);
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <vector>
+#include "ast.h"
+
+// Staticka kontrola typu po Resolveru. Kazdy slot ma pevny typ, takze typ
+// kazdeho vyrazu je znamy pri nacteni programu. TypeChecker ho doplni do
+// Expr::type a typove chyby hlasi jeste pred spustenim (se stejnymi
+// hlaskami, jake by jinak hlasil VM). Compiler pak vybira typove
+// specializovane instrukce a VM uz typy nekontroluje.
+class TypeChecker {
+public:
+    void check(Block& program, const std::vector<SlotInfo>& slots);
+
+private:
+    const std::vector<SlotInfo>* slots = nullptr;
+    const FuncDef* current = nullptr; // funkce, jejiz telo se kontroluje
+
+    Value::Type checkExpr(Expr& e);
+    Value::Type checkCall(Expr& e);
+    void checkFunction(FuncDef& f);
+    void checkBlock(Block& block);
+};
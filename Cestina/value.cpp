@@ -0,0 +1,137 @@
+#include "value.h"
+#include <charconv>
+#include <cstdint>
+#include <new>
+
+// FNV-1a a na konec promichani, aby i hornich 7 bitu (ctrl bajt
+// slovniku) zaviselo na vsech znacich
+static uint64_t hashString(std::string_view s) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (char c : s) h = (h ^ (unsigned char)c) * 0x100000001b3ull;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h | 1;
+}
+
+StrObj* StrObj::make(std::string_view s) {
+    void* mem = ::operator new(sizeof(StrObj) + s.size());
+    StrObj* o = static_cast<StrObj*>(mem);
+    o->refs = 1;
+    o->len = (uint32_t)s.size();
+    o->hash = hashString(s);
+    std::memcpy(o + 1, s.data(), s.size());
+    return o;
+}
+
+void StrObj::destroy(StrObj* o) {
+    ::operator delete(o);
+}
+
+// U pole se pocita delka v dobe alokace; shrink() ji zmensi i tady, aby
+// destroy odecetl presne tolik, kolik se pricetlo.
+static thread_local int64_t liveBytes = 0;
+
+int64_t heapBytes() {
+    return liveBytes;
+}
+
+void countHeapBytes(int64_t delta) {
+    liveBytes += delta;
+}
+
+void ArrObj::shrink(size_t n) {
+    liveBytes -= (int64_t)((len - n) * 8);
+    len = n;
+}
+
+// hlavicka bez inicializovanych prvku
+static ArrObj* allocArr(size_t n) {
+    if (n > (SIZE_MAX - sizeof(ArrObj)) / 8) throw std::bad_alloc();
+    ArrObj* o = static_cast<ArrObj*>(::operator new(sizeof(ArrObj) + n * 8));
+    o->refs = 1;
+    o->reserved = 0;
+    o->len = n;
+    liveBytes += (int64_t)(n * 8);
+    return o;
+}
+
+ArrObj* ArrObj::make(size_t n) {
+    ArrObj* o = allocArr(n);
+    std::memset(o + 1, 0, n * 8);
+    return o;
+}
+
+ArrObj* ArrObj::clone(const ArrObj* src) {
+    ArrObj* o = allocArr(src->len);
+    std::memcpy(o + 1, src + 1, src->len * 8);
+    return o;
+}
+
+void ArrObj::destroy(ArrObj* o) {
+    liveBytes -= (int64_t)(o->len * 8);
+    ::operator delete(o);
+}
+
+ArrObj* Value::uniqueArr() {
+    if (arr->refs > 1) {
+        arr->refs--;
+        arr = ArrObj::clone(arr);
+    }
+    return arr;
+}
+
+void Value::releaseObj() {
+    if (type == STRING) { if (--s->refs == 0) StrObj::destroy(s); }
+    else if (type >= DICT_INT) { if (--dict->refs == 0) DictObj::destroy(dict); }
+    else if (--arr->refs == 0) ArrObj::destroy(arr);
+}
+
+DictObj* Value::uniqueDict() {
+    if (dict->refs > 1) {
+        dict->refs--;
+        dict = DictObj::clone(dict);
+    }
+    return dict;
+}
+
+std::string_view Value::format(char (&buf)[32]) const {
+    switch (type) {
+    case INT: {
+        auto r = std::to_chars(buf, buf + sizeof buf, i);
+        return { buf, (size_t)(r.ptr - buf) };
+    }
+    case FLOAT: {
+        // general s presnosti 6 odpovida vychozimu formatu ostream << double
+        auto r = std::to_chars(buf, buf + sizeof buf, f, std::chars_format::general, 6);
+        return { buf, (size_t)(r.ptr - buf) };
+    }
+    case BOOL: return b ? "pravda" : "nepravda";
+    case STRING: return str();
+    default: return "none";
+    }
+}
+
+std::string Value::toString() const {
+    char buf[32];
+    if (isDict()) {
+        // {klic: hodnota, "retezec": hodnota} v poradi vkladani
+        std::string out = "{";
+        for (uint32_t k = 0; k < dict->len; k++) {
+            const DictEntry& e = dict->entries[k];
+            if (k) out += ", ";
+            if (e.hash & 1) out.append("\"").append(e.key.s->view()).append("\"");
+            else out += make_int(e.key.i).format(buf);
+            out += ": ";
+            out += type == DICT_INT ? make_int(e.value.i).format(buf) : make_float(e.value.f).format(buf);
+        }
+        return out + "}";
+    }
+    if (!isArray()) return std::string(format(buf));
+    std::string out = "[";
+    for (size_t k = 0; k < arr->len; k++) {
+        if (k) out += ", ";
+        out += element(k).format(buf);
+    }
+    return out + "]";
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// Nemenny retezec s pocitadlem referenci. Znaky nasleduji hned za hlavickou,
+// retezec je tak jedna alokace a kopie Value jen zvysi refs. Hash se
+// spocita jednou pri vytvoreni, klic slovniku ho pak uz jen cte.
+struct StrObj {
+    int32_t refs;
+    uint32_t len;
+    uint64_t hash; // nejnizsi bit je vzdy 1, viz DictEntry
+    const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+    std::string_view view() const { return { data(), len }; }
+    static StrObj* make(std::string_view s);
+    static void destroy(StrObj* o);
+};
+
+// Pole cisel (pole cele_cislo / pole plout) s pocitadlem referenci. Prvky
+// maji 8 bajtu a nasleduji hned za hlavickou. Kopie Value pole sdili,
+// zapis do sdileneho pole ho nejdriv zkopiruje (Value::uniqueArr), takze
+// se pole chovaji jako hodnoty.
+struct ArrObj {
+    int32_t refs;
+    uint32_t reserved;
+    size_t len;
+    template <class T> T* elems() { return reinterpret_cast<T*>(this + 1); }
+    template <class T> const T* elems() const { return reinterpret_cast<const T*>(this + 1); }
+    static ArrObj* make(size_t n); // vyplnene nulami
+    static ArrObj* clone(const ArrObj* o);
+    static void destroy(ArrObj* o);
+    // zkrati pole na n prvku, pamet zustava alokovana az do destroy
+    void shrink(size_t n);
+};
+
+// Bajty prvku poli a tabulek slovniku alokovanych v tomto vlakne a dosud
+// neuvolnenych (limit pameti VM).
+int64_t heapBytes();
+void countHeapBytes(int64_t delta);
+
+struct Value;
+
+// Polozka slovniku: klic cele_cislo nebo retezec a 8 bajtu hodnoty.
+// Nejnizsi bit hashe rika, jestli je klic retezec, shoda hashu tak
+// zaroven znamena shodu typu klice.
+struct DictEntry {
+    uint64_t hash;
+    union { long long i; StrObj* s; } key;
+    union { long long i; double f; } value;
+};
+
+// Slovnik (slovnik cele_cislo / slovnik plout) s pocitadlem referenci.
+// Polozky lezi v poradi vkladani v hustem poli entries, tabulka je
+// otevrena adresace po skupinach 16 slotu: ctrl bajt slotu je prazdny
+// (0x80) nebo 7 bitu hashe, celou skupinu porovna jedna instrukce SSE2
+// a klic se overi jen u shodnych bajtu. Polozky se nemazou, tabulka
+// tak nema nahrobky. Kopie Value slovnik sdili, zapis do sdileneho ho
+// nejdriv zkopiruje (Value::uniqueDict).
+struct DictObj {
+    int32_t refs;
+    uint32_t len;       // pocet polozek
+    uint32_t reserved;  // mista v entries
+    uint32_t groups;    // skupin tabulky (mocnina 2), 0 = zatim bez tabulky
+    uint8_t* ctrl;      // 16 * groups bajtu
+    uint32_t* index;    // slot tabulky -> polozka v entries
+    DictEntry* entries;
+
+    // prazdny slovnik, misto pro capacity polozek je rezervovane predem
+    static DictObj* make(size_t capacity);
+    static DictObj* clone(const DictObj* o);
+    static void destroy(DictObj* o);
+    // polozka klice (cele_cislo nebo retezec), nullptr kdyz chybi
+    const DictEntry* find(const Value& key) const;
+    // polozka klice, chybejici se prida na konec s nulovou hodnotou
+    DictEntry* insert(const Value& key);
+    // misto pro n polozek, dalsi vkladani do n uz nealokuje
+    void reserve(size_t n);
+
+private:
+    const DictEntry* probe(uint64_t hash, const Value& key) const;
+    void rehash(uint32_t newGroups);
+};
+
+// Hodnota ma 16 bajtu: tag a 8 bajtu dat. Ciselne typy se kopiruji jako
+// dve slova bez alokace, retezce, pole a slovniky drzi jen ukazatel na objekt.
+struct Value {
+    // typy od STRING vys jsou objekty na halde s pocitadlem referenci
+    enum Type : uint8_t { INT, FLOAT, BOOL, NONE, STRING, ARRAY_INT, ARRAY_FLOAT, DICT_INT, DICT_FLOAT } type = NONE;
+    union {
+        long long i;
+        double f;
+        bool b;
+        StrObj* s;
+        ArrObj* arr;
+        DictObj* dict;
+    };
+
+    Value() : i(0) {}
+    Value(const Value& o) : type(o.type) { std::memcpy(&i, &o.i, sizeof i); retain(); }
+    Value(Value&& o) noexcept : type(o.type) { std::memcpy(&i, &o.i, sizeof i); o.type = NONE; }
+    Value& operator=(const Value& o) {
+        o.retain();
+        release();
+        type = o.type;
+        std::memcpy(&i, &o.i, sizeof i);
+        return *this;
+    }
+    Value& operator=(Value&& o) noexcept {
+        if (this != &o) {
+            release();
+            type = o.type;
+            std::memcpy(&i, &o.i, sizeof i);
+            o.type = NONE;
+        }
+        return *this;
+    }
+    ~Value() { release(); }
+
+    bool isObj() const { return type >= STRING; }
+    bool isArray() const { return type == ARRAY_INT || type == ARRAY_FLOAT; }
+    bool isDict() const { return type >= DICT_INT; }
+    std::string_view str() const { return s->view(); }
+    // prvek k pole jako cele_cislo nebo plout
+    Value element(size_t k) const {
+        return type == ARRAY_INT ? make_int(arr->elems<long long>()[k]) : make_float(arr->elems<double>()[k]);
+    }
+    // pole, do ktereho lze zapisovat: sdilene se nejdriv zkopiruje
+    ArrObj* uniqueArr();
+    // totez pro slovnik
+    DictObj* uniqueDict();
+
+    // typ az po alokaci: kdyz selze, v zustane prazdna hodnota
+    static Value make_string(std::string_view str) { Value v; v.s = StrObj::make(str); v.type = STRING; return v; }
+    static Value make_int(long long x) { Value v; v.type = INT; v.i = x; return v; }
+    static Value make_float(double x) { Value v; v.type = FLOAT; v.f = x; return v; }
+    static Value make_bool(bool x) { Value v; v.type = BOOL; v.b = x; return v; }
+    // type je ARRAY_INT nebo ARRAY_FLOAT, prvky jsou nulove
+    static Value make_array(Type t, size_t n) { Value v; v.arr = ArrObj::make(n); v.type = t; return v; }
+    // type je DICT_INT nebo DICT_FLOAT, capacity polozek se rezervuje predem
+    static Value make_dict(Type t, size_t capacity) { Value v; v.dict = DictObj::make(capacity); v.type = t; return v; }
+    // Textova podoba bez alokace: cisla se zapisi do buf, retezce se vrati primo.
+    // Pole a slovniky se do buf nevejdou, ty umi jen toString() a OutputSink::writeValue.
+    std::string_view format(char (&buf)[32]) const;
+    std::string toString() const;
+
+private:
+    void retain() const {
+        if (type < STRING) return;
+        if (type == STRING) s->refs++;
+        else if (type >= DICT_INT) dict->refs++;
+        else arr->refs++;
+    }
+    // cisla se uvolni bez volani, at je kod instrukci VM co nejmensi
+    void release() {
+        if (type >= STRING) releaseObj();
+    }
+    void releaseObj();
+};
+
+static_assert(sizeof(Value) <= 16, "Value ma mit nejvys 16 bajtu");
@@ -0,0 +1,553 @@
+#include "vm.h"
+#include "arith.h"
+#include "simd.h"
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <type_traits>
+
+// Zpetny skok smycky. Po CZPP_JIT_THRESHOLD pruchodech se smycka zkusi
+// prelozit; vraci index, kde pokracovat po nativnim behu, nebo -1.
+int32_t VM::hotLoop(const Chunk& chunk, int32_t back, int32_t head, Value* frame) {
+    HotLoop& h = hot[back];
+    if (!h.loop) {
+        if (++h.count != CZPP_JIT_THRESHOLD) return -1;
+        h.loop = jit.compile(chunk, head, back, limits.any() ? &budget : nullptr);
+        if (!h.loop) return -1;
+    }
+    return Jit::enter(*h.loop, frame);
+}
+
+// Misto pro operandy a prvni framy funkci; dal zasobnik roste zdvojenim.
+static const size_t CallReserve = 1 << 12;
+// Nekonecna rekurze skonci chybou driv, nez vycerpa pamet. Hloubka volani
+// ma vlastni mez: funkce bez parametru a promennych zasobnik nezvetsuje.
+static const size_t MaxStack = 1 << 22;
+static const size_t MaxCalls = 1 << 22;
+
+// Hluboke vnoreni volani: zasobnik se zvetsi na alespon need hodnot
+// (need <= MaxStack overi CZPP_GROW). Ukazatele do nej si pak volajici
+// prepocita (viz CZPP_GROW ve execute).
+void VM::growStack(size_t need) {
+    slots.resize(std::min(std::max(slots.size() * 2, need), MaxStack));
+}
+
+// Chyba za behu s pozici instrukce ve zdrojaku, stejne jako hlasky lexeru.
+// Mimo execute, at hlavni smycka nenese kod pro sestaveni hlasky.
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((noinline, cold))
+#else
+__declspec(noinline)
+#endif
+[[noreturn]] static void runtimeError(const char* msg, const Chunk& chunk, const Instr* in) {
+    size_t k = (size_t)(in - chunk.code.data());
+    if (k >= chunk.positions.size()) throw std::string(msg);
+    const SrcPos& p = chunk.positions[k];
+    throw std::string(msg) + " (radek " + std::to_string(p.line) + ", sloupec " + std::to_string(p.col) + ")";
+}
+
+// Kontrola limitu jednou za LimitInterval instrukci: cteni hodin i atomicke
+// promenne je tak na jeden pruchod smyckou zanedbatelne.
+static const int64_t LimitInterval = 1 << 16;
+
+void VM::startLimits() {
+    hit = LimitHit::None;
+    ops = 0;
+    // prvni zpetny skok rovnou zkontroluje a prideli budget
+    granted = budget = limits.any() ? 0 : INT64_MAX;
+    memBase = heapBytes();
+    if (limits.timeout > 0)
+        deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(limits.timeout));
+}
+
+// false = nektery limit je prekroceny (duvod v hit), beh se ma zastavit
+bool VM::checkLimits() {
+    ops += (uint64_t)(granted - budget);
+    if (limits.maxOps && ops > limits.maxOps) hit = LimitHit::Ops;
+    else if (limits.cancel && limits.cancel->load(std::memory_order_relaxed)) hit = LimitHit::Cancelled;
+    else if (limits.timeout > 0 && std::chrono::steady_clock::now() >= deadline) hit = LimitHit::Deadline;
+    else if (!memoryFits(0)) hit = LimitHit::Memory;
+    if (hit != LimitHit::None) return false;
+    granted = LimitInterval;
+    if (limits.maxOps && limits.maxOps - ops < (uint64_t)granted) granted = (int64_t)(limits.maxOps - ops);
+    budget = granted;
+    return true;
+}
+
+// vejde se dalsich elems prvku pole do limitu pameti?
+bool VM::memoryFits(size_t elems) {
+    if (!limits.maxMemory) return true;
+    int64_t used = heapBytes() - memBase;
+    if (used < 0) used = 0;
+    if ((uint64_t)used > limits.maxMemory) return false;
+    return elems <= (limits.maxMemory - (uint64_t)used) / 8;
+}
+
+// Aritmetika po prvcich (ARR_INT, ARR_FLOAT), vysledek nahradi levy operand.
+// Delka je kratsi z obou poli. Docasne pole, na ktere nic jineho neukazuje,
+// se prepise na miste, jinak se alokuje nove; fits(n) rozhodne, jestli se
+// nove pole vejde do limitu pameti (false = operace se neprovede).
+template <class T, class Fits>
+static bool arrayOp(BinOp op, simd::Shape shape, Value& l, Value& r, Value::Type type, Fits fits) {
+    const T* a = shape == simd::ScalarArr ? reinterpret_cast<const T*>(&l.i) : l.arr->elems<T>();
+    const T* b = shape == simd::ArrScalar ? reinterpret_cast<const T*>(&r.i) : r.arr->elems<T>();
+    size_t n = shape == simd::ArrArr ? std::min(l.arr->len, r.arr->len) : shape == simd::ArrScalar ? l.arr->len : r.arr->len;
+    Value* reuse = shape != simd::ScalarArr && l.arr->refs == 1 ? &l
+        : shape != simd::ArrScalar && r.arr->refs == 1 ? &r : nullptr;
+    if (!reuse && !fits(n)) return false;
+    Value out = reuse ? std::move(*reuse) : Value::make_array(type, n);
+    // po presunu ukazuje a nebo b stale na stejna data
+    if constexpr (std::is_same_v<T, long long>) simd::binaryInt(op, shape, out.arr->elems<T>(), a, b, n);
+    else simd::binaryFloat(op, shape, out.arr->elems<T>(), a, b, n);
+    out.arr->shrink(n);
+    l = std::move(out);
+    r = Value();
+    return true;
+}
+
+// Frame: promenne (prvnich kept si ponecha hodnotu), za nimi kopie konstant.
+void VM::initFrame(const Chunk& chunk, size_t kept) {
+    slots.resize(std::min(kept, chunk.slotNames.size()));
+    slots.resize(chunk.frameSize());
+    std::copy(chunk.constants.begin(), chunk.constants.end(), slots.begin() + chunk.slotNames.size());
+}
+
+void VM::run(const Chunk& chunk) {
+    initFrame(chunk, 0);
+    execute<false>(chunk, nullptr);
+}
+
+void VM::run(const Chunk& chunk, std::vector<Value>& vars) {
+    slots = std::move(vars);
+    initFrame(chunk, slots.size());
+    try {
+        execute<false>(chunk, nullptr);
+    }
+    catch (...) {
+        // hodnoty promennych zustanou i po chybe (prilis hluboka rekurze)
+        slots.resize(chunk.slotNames.size());
+        vars = std::move(slots);
+        throw;
+    }
+    slots.resize(chunk.slotNames.size());
+    vars = std::move(slots);
+}
+
+// cas pro InstrProfile::call a ret v nanosekundach
+static uint64_t profileNow(std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now()) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+void VM::runProfiled(const Chunk& chunk, InstrProfile& prof) {
+    prof.start(chunk);
+    initFrame(chunk, 0);
+    execute<true>(chunk, &prof);
+    prof.finish(profileNow());
+}
+
+// Profilovany beh: pri kazdem dispatchi se cas od minuleho pricte predchozi
+// instrukci. Neprofilovana instance sablony nema zadny kod navic.
+template <bool Profiled>
+void VM::execute(const Chunk& chunk, InstrProfile* prof) {
+    using Clock = std::chrono::steady_clock;
+    [[maybe_unused]] Clock::time_point last;
+    [[maybe_unused]] size_t prev = 0;
+    if constexpr (Profiled) last = Clock::now();
+    slots.resize(chunk.frameSize() + chunk.maxStack + 1 + (chunk.functions.empty() ? 0 : CallReserve));
+    calls.clear();
+    startLimits();
+    if (!Profiled && jitOn) hot.assign(chunk.code.size(), HotLoop());
+
+    const Instr* const code = chunk.code.data();
+    const Value* const constants = chunk.constants.data();
+    const FuncInfo* const funcs = chunk.functions.data();
+    Value* slot = slots.data();                 // frame programu nebo volane funkce
+    Value* sp = slots.data() + chunk.frameSize(); // prvni volne misto
+    const Instr* ip = code;
+    const Instr* in;
+    auto fits = [this](size_t n) { return memoryFits(n); }; // pro arrayOp
+
+#define CZPP_PROFILE_STEP()                                                        \
+    if constexpr (Profiled) {                                                      \
+        Clock::time_point now = Clock::now();                                      \
+        prof->step(prev, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count()); \
+        prev = (size_t)(in - code);                                                \
+        prof->counts[prev]++;                                                      \
+        last = now;                                                                \
+    }
+
+#if CZPP_THREADED_DISPATCH
+    static void* const labels[] = {
+#define CZPP_OP_LABEL(name) &&L_##name,
+        CZPP_OPCODES(CZPP_OP_LABEL)
+#undef CZPP_OP_LABEL
+    };
+#define CASE(name) L_##name:
+#define NEXT() do { in = ip++; CZPP_PROFILE_STEP(); goto *labels[(size_t)in->op]; } while (0)
+    NEXT();
+#else
+#define CASE(name) case Op::name:
+#define NEXT() break
+    for (;;) {
+        in = ip++;
+        CZPP_PROFILE_STEP();
+        switch (in->op) {
+#endif
+
+    CASE(PUSH_CONST) {
+        *sp++ = constants[in->a];
+        NEXT();
+    }
+    CASE(LOAD_SLOT) {
+        *sp++ = slot[in->a];
+        NEXT();
+    }
+    // typy uz overil TypeChecker, prevody cele_cislo/plout jsou v I2F/F2I
+    // presunem, na zasobniku nezustane dalsi reference na pole (viz SET_ELEM_*)
+    CASE(DECL_SLOT) {
+        slot[in->a] = std::move(*--sp);
+        NEXT();
+    }
+    CASE(STORE_SLOT) {
+        slot[in->a] = std::move(*--sp);
+        NEXT();
+    }
+
+#define CZPP_BINARY(name, field, expr)                                             \
+    CASE(name) {                                                                   \
+        Value& l = sp[-2];                                                         \
+        const Value& r = sp[-1];                                                   \
+        l.field = expr;                                                            \
+        --sp;                                                                      \
+        NEXT();                                                                    \
+    }
+    CZPP_BINARY(ADD_INT, i, wrapAdd(l.i, r.i))
+    CZPP_BINARY(SUB_INT, i, wrapSub(l.i, r.i))
+    CZPP_BINARY(MUL_INT, i, wrapMul(l.i, r.i))
+    CZPP_BINARY(DIV_INT, i, intDiv(l.i, r.i))
+    CZPP_BINARY(ADD_FLOAT, f, l.f + r.f)
+    CZPP_BINARY(SUB_FLOAT, f, l.f - r.f)
+    CZPP_BINARY(MUL_FLOAT, f, l.f * r.f)
+    CZPP_BINARY(DIV_FLOAT, f, l.f / r.f)
+#undef CZPP_BINARY
+
+    // porovnani: vysledek je boolean, retezce se pri prepisu uvolni
+#define CZPP_CMP(name, expr)                                                       \
+    CASE(name) {                                                                   \
+        Value& l = sp[-2];                                                         \
+        const Value& r = sp[-1];                                                   \
+        l = Value::make_bool(expr);                                                \
+        --sp;                                                                      \
+        NEXT();                                                                    \
+    }
+    CZPP_CMP(LT_INT, l.i < r.i)
+    CZPP_CMP(LE_INT, l.i <= r.i)
+    CZPP_CMP(GT_INT, l.i > r.i)
+    CZPP_CMP(GE_INT, l.i >= r.i)
+    CZPP_CMP(EQ_INT, l.i == r.i)
+    CZPP_CMP(NE_INT, l.i != r.i)
+    CZPP_CMP(LT_FLOAT, l.f < r.f)
+    CZPP_CMP(LE_FLOAT, l.f <= r.f)
+    CZPP_CMP(GT_FLOAT, l.f > r.f)
+    CZPP_CMP(GE_FLOAT, l.f >= r.f)
+    CZPP_CMP(EQ_FLOAT, l.f == r.f)
+    CZPP_CMP(NE_FLOAT, l.f != r.f)
+    CZPP_CMP(EQ_BOOL, l.b == r.b)
+    CZPP_CMP(NE_BOOL, l.b != r.b)
+    CZPP_CMP(EQ_STR, l.str() == r.str())
+    CZPP_CMP(NE_STR, l.str() != r.str())
+#undef CZPP_CMP
+
+    CASE(I2F) {
+        Value& v = sp[-1];
+        v.f = (double)v.i;
+        v.type = Value::FLOAT;
+        NEXT();
+    }
+    CASE(F2I) {
+        Value& v = sp[-1];
+        v.i = (long long)v.f;
+        v.type = Value::INT;
+        NEXT();
+    }
+
+    CASE(JUMP) {
+        ip = code + in->a;
+        NEXT();
+    }
+    CASE(JUMP_IF_FALSE) {
+        if (!truthy(*--sp)) ip = code + in->a;
+        NEXT();
+    }
+    // zpetny skok: ip uz ukazuje na zacatek tela smycky, pruchod se do
+    // limitu pocita jako delka tela
+#define CZPP_BACKEDGE()                                                            \
+    {                                                                              \
+        if ((budget -= in - ip + 1) <= 0 && !checkLimits()) return;                \
+        if (!Profiled && jitOn) {                                                  \
+            int32_t resume = hotLoop(chunk, (int32_t)(in - code), (int32_t)(ip - code), slot); \
+            if (resume >= 0) ip = code + resume;                                   \
+        }                                                                          \
+    }
+    CASE(JUMP_IF_TRUE) {
+        if (truthy(*--sp)) {
+            ip = code + in->a;
+            if (ip <= in) CZPP_BACKEDGE()
+        }
+        NEXT();
+    }
+    CASE(PRINT) {
+        out.writeValue(*--sp);
+        *sp = Value();
+        out.write("            ");
+        NEXT();
+    }
+
+    // pocitana smycka: pricteni kroku, porovnani a skok v jedne instrukci
+#define CZPP_FOR(name, cmp)                                                        \
+    CASE(name) {                                                                   \
+        long long& i = slot[in->a].i;                                              \
+        i = wrapAdd(i, ip->a);                                                     \
+        if (i cmp slot[in->b].i) {                                                 \
+            ip = code + in->c;                                                     \
+            CZPP_BACKEDGE()                                                        \
+        }                                                                          \
+        else ip++;                                                                 \
+        NEXT();                                                                    \
+    }
+    CZPP_FOR(FOR_LT, <)
+    CZPP_FOR(FOR_LE, <=)
+    CZPP_FOR(FOR_GT, >)
+    CZPP_FOR(FOR_GE, >=)
+    CZPP_FOR(FOR_NE, !=)
+#undef CZPP_FOR
+#undef CZPP_BACKEDGE
+    CASE(EXTRA_ARG) {
+        NEXT();
+    }
+
+    // Kazda nova alokace pole nebo slovniku se nejdriv porovna s limitem
+    // pameti, jinak by ji prisel checkLimits() az na pristim zpetnem skoku.
+#define CZPP_MEMORY(elems)                                                         \
+    if (!memoryFits(elems)) {                                                      \
+        hit = LimitHit::Memory;                                                    \
+        return;                                                                    \
+    }
+
+    // pole; typy a tvary operandu urcil prekladac
+    CASE(ARR_NEW) {
+        Value& v = sp[-1];
+        size_t n = v.i > 0 ? (size_t)v.i : 0;
+        CZPP_MEMORY(n)
+        // bez limitu pameti rozhodne az alokace
+        try { v = Value::make_array((Value::Type)in->a, n); }
+        catch (const std::bad_alloc&) { runtimeError("Pole je prilis velke", chunk, in); }
+        NEXT();
+    }
+    CASE(A2F) {
+        Value& v = sp[-1];
+        const ArrObj* src = v.arr;
+        CZPP_MEMORY(src->len)
+        Value res = Value::make_array(Value::ARRAY_FLOAT, src->len);
+        for (size_t k = 0; k < src->len; k++) res.arr->elems<double>()[k] = (double)src->elems<long long>()[k];
+        v = std::move(res);
+        NEXT();
+    }
+    CASE(A2I) {
+        Value& v = sp[-1];
+        const ArrObj* src = v.arr;
+        CZPP_MEMORY(src->len)
+        Value res = Value::make_array(Value::ARRAY_INT, src->len);
+        for (size_t k = 0; k < src->len; k++) res.arr->elems<long long>()[k] = (long long)src->elems<double>()[k];
+        v = std::move(res);
+        NEXT();
+    }
+    CASE(ARR_INT) {
+        if (!arrayOp<long long>((BinOp)in->a, (simd::Shape)in->b, sp[-2], sp[-1], Value::ARRAY_INT, fits)) {
+            hit = LimitHit::Memory;
+            return;
+        }
+        --sp;
+        NEXT();
+    }
+    CASE(ARR_FLOAT) {
+        if (!arrayOp<double>((BinOp)in->a, (simd::Shape)in->b, sp[-2], sp[-1], Value::ARRAY_FLOAT, fits)) {
+            hit = LimitHit::Memory;
+            return;
+        }
+        --sp;
+        NEXT();
+    }
+    // index mimo rozsah cte 0 a zapis ignoruje, jazyk nema chyby za behu
+#define CZPP_INDEX(name, T, make)                                                  \
+    CASE(name) {                                                                   \
+        Value& v = sp[-2];                                                         \
+        unsigned long long k = (unsigned long long)sp[-1].i;                       \
+        T x = k < v.arr->len ? v.arr->elems<T>()[k] : 0;                           \
+        v = Value::make(x);                                                        \
+        --sp;                                                                      \
+        NEXT();                                                                    \
+    }
+    CZPP_INDEX(INDEX_INT, long long, make_int)
+    CZPP_INDEX(INDEX_FLOAT, double, make_float)
+#undef CZPP_INDEX
+    // sdilene pole se pred zapisem zkopiruje, ostatni promenne ho tak nevidi
+#define CZPP_SET_ELEM(name, T, field)                                              \
+    CASE(name) {                                                                   \
+        Value& v = slot[in->a];                                                    \
+        unsigned long long k = (unsigned long long)sp[-2].i;                       \
+        if (k < v.arr->len) {                                                      \
+            if (v.arr->refs > 1) CZPP_MEMORY(v.arr->len)                           \
+            v.uniqueArr()->elems<T>()[k] = sp[-1].field;                           \
+        }                                                                          \
+        sp -= 2;                                                                   \
+        NEXT();                                                                    \
+    }
+    CZPP_SET_ELEM(SET_ELEM_INT, long long, i)
+    CZPP_SET_ELEM(SET_ELEM_FLOAT, double, f)
+#undef CZPP_SET_ELEM
+    CASE(REDUCE_INT) {
+        Value& v = sp[-1];
+        long long x = simd::reduceInt((simd::Reduce)in->a, v.arr->elems<long long>(), v.arr->len);
+        v = Value::make_int(x);
+        NEXT();
+    }
+    CASE(REDUCE_FLOAT) {
+        Value& v = sp[-1];
+        double x = simd::reduceFloat((simd::Reduce)in->a, v.arr->elems<double>(), v.arr->len);
+        v = Value::make_float(x);
+        NEXT();
+    }
+    CASE(LEN) {
+        Value& v = sp[-1];
+        long long n = (long long)v.arr->len;
+        v = Value::make_int(n);
+        NEXT();
+    }
+
+    // slovniky; klic na zasobniku je cele_cislo nebo retezec
+    CASE(DICT_NEW) {
+        Value& v = sp[-1];
+        size_t n = v.i > 0 ? (size_t)v.i : 0;
+        // polozka s podilem tabulky je asi 30 bajtu, pocita se jako 4 prvky pole
+        CZPP_MEMORY(n < SIZE_MAX / 4 ? n * 4 : SIZE_MAX)
+        // nad MaxEntries polozek nebo bez pameti jako u ARR_NEW
+        try { v = Value::make_dict((Value::Type)in->a, n); }
+        catch (const std::bad_alloc&) { runtimeError("Slovnik je prilis velky", chunk, in); }
+        NEXT();
+    }
+    // chybejici klic cte 0 stejne jako index mimo pole
+#define CZPP_DICT_GET(name, field, make)                                           \
+    CASE(name) {                                                                   \
+        Value& v = sp[-2];                                                         \
+        const DictEntry* e = v.dict->find(sp[-1]);                                 \
+        v = Value::make(e ? e->value.field : 0);                                   \
+        --sp;                                                                      \
+        NEXT();                                                                    \
+    }
+    CZPP_DICT_GET(DICT_GET_INT, i, make_int)
+    CZPP_DICT_GET(DICT_GET_FLOAT, f, make_float)
+#undef CZPP_DICT_GET
+    // jako SET_ELEM_*: sdileny slovnik se pred zapisem zkopiruje; rust
+    // nad MaxEntries polozek konci chybou jako DICT_NEW
+#define CZPP_DICT_SET(name, field)                                                 \
+    CASE(name) {                                                                   \
+        const DictObj* d = slot[in->a].dict;                                       \
+        size_t grow = (d->refs > 1 ? d->reserved : 0) + (d->len == d->reserved ? d->reserved * 2 + 4 : 0); \
+        if (grow) CZPP_MEMORY(grow * 4)                                            \
+        try { slot[in->a].uniqueDict()->insert(sp[-2])->value.field = sp[-1].field; } \
+        catch (const std::bad_alloc&) { runtimeError("Slovnik je prilis velky", chunk, in); } \
+        sp -= 2;                                                                   \
+        NEXT();                                                                    \
+    }
+    CZPP_DICT_SET(DICT_SET_INT, i)
+    CZPP_DICT_SET(DICT_SET_FLOAT, f)
+#undef CZPP_DICT_SET
+    CASE(DICT_HAS) {
+        Value& v = sp[-2];
+        bool found = v.dict->find(sp[-1]) != nullptr;
+        v = Value::make_bool(found);
+        --sp;
+        NEXT();
+    }
+    CASE(DICT_LEN) {
+        Value& v = sp[-1];
+        long long n = (long long)v.dict->len;
+        v = Value::make_int(n);
+        NEXT();
+    }
+
+    // Volani: argumenty na vrcholu zasobniku jsou rovnou prvni sloty framu,
+    // nad nimi zbytek lokalnich promennych a operandy volane funkce. Jako
+    // zpetny skok se do limitu pocita delka tela funkce (i rekurze bez
+    // smycek tak limity dodrzi).
+    // sp a slot se predavaji jen jako posun, at zustanou v registrech
+#define CZPP_GROW(need)                                                            \
+    {                                                                              \
+        size_t spAt = (size_t)(sp - slots.data()), slotAt = (size_t)(slot - slots.data()); \
+        if ((need) > MaxStack) runtimeError("Prilis hluboka rekurze", chunk, in); \
+        growStack(need);                                                           \
+        sp = slots.data() + spAt;                                                  \
+        slot = slots.data() + slotAt;                                              \
+    }
+    CASE(CALL) {
+        const FuncInfo& f = funcs[in->a];
+        if ((budget -= f.end - f.entry) <= 0 && !checkLimits()) return;
+        // rekurze muze drzet pole ve framech i bez jedineho zpetneho skoku
+        CZPP_MEMORY(0)
+        if ((size_t)(slots.data() + slots.size() - sp) + in->b < f.frameSize())
+            CZPP_GROW((size_t)(sp - in->b - slots.data()) + f.frameSize())
+        if (calls.size() == MaxCalls) runtimeError("Prilis hluboka rekurze", chunk, in);
+        calls.push_back({ ip, (size_t)(slot - slots.data()) });
+        if constexpr (Profiled) prof->call((size_t)(in - code), profileNow(last));
+        slot = sp - in->b;
+        sp = slot + f.locals();
+        ip = code + f.entry;
+        NEXT();
+    }
+    // volani na konci funkce: argumenty se presunou na zacatek jejiho framu
+    // a volana funkce ho prevezme, navrat jde rovnou k puvodnimu volajicimu
+    CASE(TAILCALL) {
+        const FuncInfo& f = funcs[in->a];
+        if ((budget -= f.end - f.entry) <= 0 && !checkLimits()) return;
+        Value* args = sp - in->b;
+        if (args != slot)
+            for (int32_t k = 0; k < in->b; k++) slot[k] = std::move(args[k]);
+        for (Value* v = slot + in->b; v < sp; v++) *v = Value();
+        sp = slot + in->b;
+        if ((size_t)(slots.data() + slots.size() - slot) < f.frameSize())
+            CZPP_GROW((size_t)(slot - slots.data()) + f.frameSize())
+        sp = slot + f.locals();
+        ip = code + f.entry;
+        NEXT();
+    }
+    // vysledek na misto prvniho argumentu, lokalni promenne se uvolni
+    CASE(RET) {
+        if (sp - 1 != slot) *slot = std::move(sp[-1]);
+        for (Value* v = slot + 1; v < sp; v++) *v = Value();
+        sp = slot + 1;
+        const CallFrame& back = calls.back();
+        ip = back.ret;
+        slot = slots.data() + back.base;
+        calls.pop_back();
+        if constexpr (Profiled) prof->ret(profileNow(last));
+        NEXT();
+    }
+#undef CZPP_GROW
+#undef CZPP_MEMORY
+    CASE(POP) {
+        *--sp = Value();
+        NEXT();
+    }
+    CASE(HALT) {
+        return;
+    }
+
+#if !CZPP_THREADED_DISPATCH
+        }
+    }
+#endif
+#undef CASE
+#undef NEXT
+#undef CZPP_PROFILE_STEP
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+#include "bytecode.h"
+#include "jit.h"
+#include "runlimits.h"
+#include "output.h"
+#include "profile.h"
+
+// Vlaknovy dispatch (computed goto) umi jen GCC a Clang, jinde (MSVC) se
+// pouzije obycejny switch.
+#ifndef CZPP_THREADED_DISPATCH
+#if defined(__GNUC__) || defined(__clang__)
+#define CZPP_THREADED_DISPATCH 1
+#else
+#define CZPP_THREADED_DISPATCH 0
+#endif
+#endif
+
+// Zasobnikovy virtualni stroj nad prelozenym Chunkem. Vsechny hodnoty
+// lezi v jednom souvislem poli: frame programu (promenne a konstanty),
+// nad nim operandy a nad nimi framy volanych funkci. Argumenty volani
+// se stanou prvnimi sloty framu volane funkce na miste, kde jsou.
+class VM {
+public:
+    explicit VM(OutputSink& out) : out(out) {}
+    void run(const Chunk& chunk);
+    // navazujici beh (inkrementalni REPL): vars jsou hodnoty promennych
+    // z minula, chunk je cte na stejnych slotech; po behu obsahuji nove hodnoty
+    void run(const Chunk& chunk, std::vector<Value>& vars);
+    // beh s merenim kazde instrukce, vzdy bez JIT (viz ProfileReport)
+    void runProfiled(const Chunk& chunk, InstrProfile& prof);
+    // horke smycky prekladat do nativniho kodu (jen kde je JIT k dispozici)
+    void setJit(bool on) { jitOn = on && Jit::available(); }
+    // limity behu; po run() limitHit() rika, zda a proc beh skoncil predcasne
+    void setLimits(const RunLimits& l) { limits = l; }
+    LimitHit limitHit() const { return hit; }
+
+private:
+    // stav jedne smycky podle jejiho zpetneho skoku
+    struct HotLoop {
+        uint32_t count = 0;
+        const JitLoop* loop = nullptr;
+    };
+
+    // navrat z funkce: kam pokracovat a kde zacina frame volajiciho
+    struct CallFrame {
+        const Instr* ret;
+        size_t base;
+    };
+
+    OutputSink& out;
+    std::vector<Value> slots;     // frame programu, operandy a framy funkci
+    std::vector<CallFrame> calls;
+    bool jitOn = Jit::available();
+    Jit jit;
+    std::vector<HotLoop> hot;
+
+    // Zpetne skoky (i v JIT) odecitaji delku tela smycky od budget, teprve
+    // kdyz dojde, checkLimits() overi vsechny limity a prideli dalsi davku.
+    // Bez limitu je budget prakticky nekonecny.
+    RunLimits limits;
+    LimitHit hit = LimitHit::None;
+    int64_t budget = INT64_MAX;
+    int64_t granted = 0;  // budget pri posledni kontrole
+    uint64_t ops = 0;     // instrukce do posledni kontroly
+    int64_t memBase = 0;  // heapBytes() pri startu
+    std::chrono::steady_clock::time_point deadline;
+
+    void initFrame(const Chunk& chunk, size_t kept);
+    template <bool Profiled>
+    void execute(const Chunk& chunk, InstrProfile* prof);
+    int32_t hotLoop(const Chunk& chunk, int32_t back, int32_t head, Value* frame);
+    void growStack(size_t need);
+    void startLimits();
+    bool checkLimits();
+    bool memoryFits(size_t elems);
+};